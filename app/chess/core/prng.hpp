@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+// xorshift64* generator, usable at compile time
+class Prng {
+    uint64_t s;
+
+    constexpr uint64_t rand64() {
+        s ^= s >> 12, s ^= s << 25, s ^= s >> 27;
+        return s * 2685821657736338717LL;
+    }
+
+   public:
+    explicit constexpr Prng(uint64_t seed) : s(seed) { assert(seed); }
+
+    template <typename T>
+    constexpr T rand() {
+        return T(rand64());
+    }
+
+    template <typename T>
+    constexpr T sparseRand() {
+        return T(rand64() & rand64() & rand64());
+    }
+};
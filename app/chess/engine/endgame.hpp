@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+
+#include "bit_operations.hpp"
+#include "color.hpp"
+#include "piece_type.hpp"
+#include "position.hpp"
+#include "square.hpp"
+
+// evaluations for the endgames the general one gets wrong. they look at the position from the strong side and turn
+// the score to the side to move at the end
+namespace Endgames {
+using Function = int (*)(const Position& position, Color strong);
+
+inline constexpr int KNOWN_WIN = 10000;  // above anything the general evaluation returns, below the mate scores
+
+// 0 on the four center squares, up to 6 in a corner
+[[nodiscard]] constexpr int centerDistance(Square square) {
+    const int file = square.file().value();
+    const int rank = square.rank().value();
+    return std::max(3 - file, file - 4) + std::max(3 - rank, rank - 4);
+}
+
+[[nodiscard]] inline int forSideToMove(const Position& position, Color strong, int score) {
+    return position.us() == strong ? score : -score;
+}
+
+// nothing left on the board that could mate
+inline int draw(const Position& /*position*/, Color /*strong*/) { return 0; }
+
+// a rook or more against the bare king: drive it to the edge and bring the own king along
+inline int mateBareKing(const Position& position, Color strong) {
+    const Square strong_king = lsb(position.occupancy(strong, PieceTypes::KING));
+    const Square weak_king   = lsb(position.occupancy(!strong, PieceTypes::KING));
+
+    const int score = KNOWN_WIN + position.psqt(strong).endgame() + 20 * centerDistance(weak_king) +
+                      10 * (7 - Square::distance(strong_king, weak_king));
+    return forSideToMove(position, strong, score);
+}
+
+// bishops alone need both square colors, on one color they can never take the last flight square. the material key
+// doesn't tell the colors apart, so they are looked at here
+inline int mateBishops(const Position& position, Color strong) {
+    Bitboard   bishops = position.occupancy(strong, PieceTypes::BISHOP);
+    const bool light   = lsb(bishops).light();
+
+    while (bishops.any()) {
+        if (poplsb(bishops).light() != light) return mateBareKing(position, strong);
+    }
+    return draw(position, strong);
+}
+
+// bishop and knight can only mate in a corner of the bishop's color, the king is driven to the nearer one
+inline int mateBishopKnight(const Position& position, Color strong) {
+    const Square strong_king = lsb(position.occupancy(strong, PieceTypes::KING));
+    const Square weak_king   = lsb(position.occupancy(!strong, PieceTypes::KING));
+    const bool   light       = lsb(position.occupancy(strong, PieceTypes::BISHOP)).light();
+
+    const int corner = std::min(Square::distance(weak_king, light ? Squares::H1 : Squares::A1),
+                                Square::distance(weak_king, light ? Squares::A8 : Squares::H8));
+
+    const int score = KNOWN_WIN + 30 * (7 - corner) + 10 * (7 - Square::distance(strong_king, weak_king));
+    return forSideToMove(position, strong, score);
+}
+};  // namespace Endgames
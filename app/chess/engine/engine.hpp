@@ -1,209 +1,140 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <thread>
 #include <vector>
 
 #include "evaluation.hpp"
 #include "history.hpp"
 #include "move.hpp"
+#include "perft.hpp"
+#include "perft_table.hpp"
 #include "position.hpp"
+#include "search_stack.hpp"
+#include "search_thread.hpp"
+#include "search_worker.hpp"
 #include "square.hpp"
-
-struct SearchParameters {
-    int max_depth = -1;
-
-    int max_time_ms = -1;
-
-    int wtime_ms = -1;
-    int btime_ms = -1;
-};
+#include "transposition_table.hpp"
 
 class Engine {
    public:
+    static constexpr size_t MAX_MULTI_PV = SearchFrame::MAX_MOVES;
+    static constexpr size_t MAX_THREADS  = 256;
+
     explicit Engine(bool run_search_on_change = false, int search_max_time_ms = 5000) {
         Magics::get();
+        setThreads(1);
 
         if (run_search_on_change) {
             m_search_max_time_ms = search_max_time_ms;
         }
         trySearchOnChange();
     }
-    void newGame() { m_position.fromFen(); }
-
-    void        fromFen(const std::string& fen) { m_position.fromFen(fen); }
-    std::string toFen() { return m_position.toFen(); }
+    ~Engine() { stop(); }
 
-    void go(const SearchParameters& parameters) {
-        m_stop_search = false;
-        if (m_search_thread.joinable()) {
-            m_search_thread.join();
-        }
+    Engine(const Engine&)            = delete;
+    Engine& operator=(const Engine&) = delete;
 
-        SearchParameters effective_parameters = parameters;
+    // a different game, what the workers learned in the last one is dropped. the tables are large, a new position
+    // of the same game keeps them
+    void newGame() {
+        stop();
+        startPosition();
 
-        if (parameters.wtime_ms != -1 || parameters.btime_ms != -1) {
-            int time_left = (m_position.us() == Colors::WHITE) ? parameters.wtime_ms : parameters.btime_ms;
-
-            if (time_left != -1) {
-                int time_to_use = time_left / 50;
-
-                int max_allowable                = std::max(0, time_left - 50);
-                effective_parameters.max_time_ms = std::min(std::max(time_to_use, 5), max_allowable);
-            }
-        }
-
-        m_search_thread = std::thread(&Engine::search, this, m_position, effective_parameters);
+        for (auto& worker : m_workers) worker->clear();
     }
 
-    void search(Position position, const SearchParameters& parameters) {
-        m_nodes          = 0;
-        m_start_time     = std::chrono::steady_clock::now();
-        m_allocated_time = parameters.max_time_ms;
-
-        std::array<Move, 256> possible_moves{};
-        size_t                size = position.generateMoves<GenerationTypes::LEGAL>(possible_moves.data());
-        if (size == 0) {
-            std::cout << "bestmove (none)" << std::endl;
-            m_stop_search = true;
-            return;
-        }
-
-        m_best_move   = possible_moves[0];
-        int max_depth = (parameters.max_depth != -1) ? parameters.max_depth : 64;
-
-        for (int depth = 1; depth <= max_depth; ++depth) {
-            if (m_stop_search) break;
-
-            m_current_depth = depth;
-            int alpha       = -Evaluation::MATE_SCORE;
-            int beta        = Evaluation::MATE_SCORE;
-
-            auto it = std::find_if(possible_moves.begin(), possible_moves.end(),
-                                   [this](const Move& move) { return move == this->m_best_move; });
-
-            if (it != possible_moves.end()) {
-                std::swap(possible_moves[0], *it);
-            }
-
-            Move current_best_move   = m_best_move;
-            int  best_score_at_depth = -Evaluation::MATE_SCORE;
-
-            for (size_t i = 0; i < size; i++) {
-                if (m_stop_search) break;
-
-                Move const& move = possible_moves[i];
-                auto        undo = position.makeMove(move);
-
-                int score = -minimax(position, depth - 1, -beta, -alpha, 1);
-
-                position.unmakeMove(move, undo);
-
-                if (m_stop_search) break;
-
-                if (score > best_score_at_depth) {
-                    best_score_at_depth = score;
-                    current_best_move   = move;
-                }
-
-                alpha = std::max(alpha, best_score_at_depth);
-            }
-
-            if (!m_stop_search) {
-                m_best_move         = current_best_move;
-                m_current_best_move = current_best_move;
-                m_current_eval      = best_score_at_depth;
-            }
-        }
-
-        std::cout << "bestmove " << m_best_move.toString() << std::endl;
-        m_stop_search = true;
+    void setHashSize(size_t size_mb) {
+        stop();
+        m_tt.resize(size_mb);
     }
-    int minimax(Position& position, int depth, int alpha, int beta, int ply) {
-        if ((m_nodes++ & 1023) == 0) checkTime();
-        if (m_stop_search) return 0;
-
-        if (depth <= 0) {
-            return Evaluation::evaluate(position);
-        }
-
-        std::array<Move, 256> moves_{};
-        size_t                size = position.generateMoves<GenerationTypes::ALL>(moves_.data());
-
-        auto scoreMove = [&](const Move& m) {
-            if (position.at(m.to()) != Pieces::NONE) {
-                return 10 * Evaluation::pieceValue(position.at(m.to()).type()) -
-                       Evaluation::pieceValue(position.at(m.from()).type());
-            }
-            return 0;
-        };
-        std::sort(moves_.begin(), moves_.begin() + size,
-                  [&](const Move& a, const Move& b) { return scoreMove(a) > scoreMove(b); });
-
-        int best_score        = -Evaluation::MATE_SCORE;
-        int legal_moves_count = 0;
-
-        for (size_t i = 0; i < size; i++) {
-            Move const& move = moves_[i];
-            auto        undo = position.makeMove(move);
-
-            if (position.isLegal<false>()) {
-                legal_moves_count++;
-
-                int score = -minimax(position, depth - 1, -beta, -alpha, ply + 1);
-
-                position.unmakeMove(move, undo);
+    void clearHash() {
+        stop();
+        m_tt.clear();
+    }
+    [[nodiscard]] int hashfull() const { return m_tt.hashfull(); }
 
-                if (m_stop_search) return 0;
+    // the number of best lines searched and reported, one outside of analysis
+    void setMultiPV(size_t lines) {
+        stop();
+        m_options.multi_pv = std::clamp<size_t>(lines, 1, MAX_MULTI_PV);
+    }
 
-                if (score > best_score) {
-                    best_score = score;
-                    if (score > alpha) {
-                        alpha = score;
-                        if (alpha >= beta) break;
-                    }
-                }
-            } else {
-                position.unmakeMove(move, undo);
-            }
+    // one main worker and threads - 1 helpers, the ones that stay keep what they learned
+    void setThreads(size_t threads) {
+        if (!m_threads.empty()) stop();
+        threads = std::clamp<size_t>(threads, 1, MAX_THREADS);
+
+        m_threads.resize(std::min(threads, m_threads.size()));
+        m_workers.resize(std::min(threads, m_workers.size()));
+        while (m_workers.size() < threads) {
+            m_workers.push_back(
+                std::make_unique<SearchWorker>(m_workers.size(), m_workers, m_tt, m_options, m_time, m_stop_search));
+            m_threads.push_back(std::make_unique<SearchThread>());
         }
+    }
 
-        if (legal_moves_count == 0) {
-            if (position.isCheck()) return -Evaluation::MATE_SCORE + ply;
-            return 0;
-        }
+    // subtracted from the clock for every move, the time lost between the engine and the gui
+    void setMoveOverhead(int overhead_ms) {
+        stop();
+        m_move_overhead_ms = std::clamp(overhead_ms, 0, TimeManager::MAX_MOVE_OVERHEAD_MS);
+    }
 
-        return best_score;
+    // quiet checking moves in the first quiescence ply, off by default
+    void setQSearchChecks(bool enabled) {
+        stop();
+        m_options.qsearch_checks = enabled;
     }
 
-    void checkTime() {
-        if (m_allocated_time == -1) return;
+    void startPosition() {
+        m_position.fromFen();
+        m_history.clear();
+    }
+    void fromFen(const std::string& fen) {
+        m_position.fromFen(fen);
+        m_history.clear();
+    }
+    std::string toFen() { return m_position.toFen(); }
 
-        auto now        = std::chrono::steady_clock::now();
-        auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_start_time).count();
+    void go(const SearchParameters& parameters) {
+        prepareSearch(m_position, parameters);
+        m_root_keys = m_history.getKeyHistory();
+        m_threads[0]->start([this] { search(); });
+    }
 
-        if (elapsed_ms >= m_allocated_time) {
-            m_stop_search = true;
-        }
+    // searches on the calling thread and returns once the best move is out. the position comes without the game
+    // that led to it, only repetitions inside the search are seen
+    void search(const Position& position, const SearchParameters& parameters) {
+        prepareSearch(position, parameters);
+        m_root_keys.clear();
+        search();
     }
 
     void stop() {
         m_stop_search = true;
-        if (m_search_thread.joinable()) {
-            m_search_thread.join();
-        }
+        m_threads[0]->wait();
     }
 
-    uint64_t perft(int depth) {
-        if (depth > 64) throw std::runtime_error("The depth cant be > 64");
-        static std::array<Move, 256 * 64> move_stack{};
+    // hash_mb = 0 disables the subtree cache
+    uint64_t perft(int depth, size_t hash_mb = 0, size_t threads = 1) {
+        if (depth > Perft::MAX_DEPTH) throw std::runtime_error("The depth cant be > 64");
+
+        std::unique_ptr<PerftTable> table = hash_mb > 0 ? std::make_unique<PerftTable>(hash_mb) : nullptr;
 
         using Clock = std::chrono::high_resolution_clock;
         auto start  = Clock::now();
 
-        uint64_t total = perft<true>(depth, move_stack.data());
+        uint64_t total = depth <= 0 ? 1 : 0;
+        for (const auto& [move, nodes] : Perft::divide(m_position, depth, table.get(), threads)) {
+            std::cout << move.toString() << ": " << nodes << '\n';
+            total += nodes;
+        }
 
         auto                          end     = Clock::now();
         std::chrono::duration<double> elapsed = end - start;
@@ -240,8 +171,9 @@ class Engine {
 
         if (it == move_list.begin() + size) throw std::runtime_error("Invalid move");
 
-        auto undo_info = m_position.makeMove(*it);
-        m_history.push(*it, undo_info);
+        const Key key       = m_position.key();
+        auto      undo_info = m_position.makeMove(*it);
+        m_history.push(*it, undo_info, key);
 
         trySearchOnChange();
     }
@@ -268,8 +200,9 @@ class Engine {
 
             if (it == move_list.begin() + size) throw std::runtime_error("Invalid move");
 
-            auto undo_info = m_position.makeMove(*it);
-            m_history.push(*it, undo_info);
+            const Key key       = m_position.key();
+            auto      undo_info = m_position.makeMove(*it);
+            m_history.push(*it, undo_info, key);
         } else {
             auto it = std::ranges::find_if(move_list.begin(), move_list.begin() + size, [&](const Move& m) {
                 return m.from() == target.from() && m.to() == target.to() && m.flag() == target.flag();
@@ -277,8 +210,9 @@ class Engine {
 
             if (it == move_list.begin() + size) throw std::runtime_error("Invalid move");
 
-            auto undo_info = m_position.makeMove(*it);
-            m_history.push(*it, undo_info);
+            const Key key       = m_position.key();
+            auto      undo_info = m_position.makeMove(*it);
+            m_history.push(*it, undo_info, key);
         }
 
         trySearchOnChange();
@@ -287,15 +221,15 @@ class Engine {
     void unmakeMove() {
         m_moves_dirty = true;
 
-        auto [move, undo_info] = m_history.pop();
-        m_position.unmakeMove(move, undo_info);
+        const HistoryEntry entry = m_history.pop();
+        m_position.unmakeMove(entry.move, entry.undo_info);
 
         trySearchOnChange();
     }
 
-    [[nodiscard]] Move  getCurrentBestMove() const { return m_current_best_move; }
-    [[nodiscard]] int   getCurrentDepth() const { return m_current_depth; }
-    [[nodiscard]] int   getCurrentEval() const { return m_current_eval; }
+    [[nodiscard]] Move  getCurrentBestMove() const { return bestWorker().bestMove(); }
+    [[nodiscard]] int   getCurrentDepth() const { return m_workers[0]->currentDepth(); }
+    [[nodiscard]] int   getCurrentEval() const { return bestWorker().bestScore(); }
     [[nodiscard]] Color getSideToMove() const { return m_position.us(); }
     [[nodiscard]] bool  isGameOver() {
         auto _moves = moves();
@@ -305,48 +239,110 @@ class Engine {
     [[nodiscard]] std::vector<Move> getMoveHistory() const { return m_history.getMoveHistory(); }
 
    private:
-    Position m_position{};
+    // whatever runs the search, the last one has to be over and the stop it ended with lifted
+    void prepareSearch(const Position& position, const SearchParameters& parameters) {
+        m_threads[0]->wait();
+        m_stop_search = false;
 
-    History m_history{};
+        m_tt.newSearch();
+        for (auto& worker : m_workers) worker->newSearch();
 
-    template <bool Root>
-    uint64_t perft(int depth, Move* move_list) {
-        if (depth == 0) return 1;
+        m_root_position     = position;
+        m_search_parameters = parameters;
+    }
 
-        size_t   size  = m_position.generateMoves<GenerationTypes::ALL>(move_list);
-        uint64_t nodes = 0;
+    // lazy smp: every worker searches the whole tree on its own, they only share the transposition table
+    // runs on the first thread, or on the caller's. the helper threads are woken up for the time of the search
+    void search() {
+        const bool white = m_root_position.us() == Colors::WHITE;
+        m_time.init(TimeManager::Clock::now(), white ? m_search_parameters.wtime_ms : m_search_parameters.btime_ms,
+                    white ? m_search_parameters.winc_ms : m_search_parameters.binc_ms, m_search_parameters.movestogo,
+                    m_search_parameters.max_time_ms, m_move_overhead_ms);
+        for (auto& worker : m_workers) worker->resetCounters();
+
+        for (size_t i = 1; i < m_workers.size(); ++i) {
+            m_threads[i]->start(
+                [this, i] { m_workers[i]->search(m_root_position, m_root_keys, m_search_parameters); });
+        }
 
-        for (size_t i = 0; i < size; ++i) {
-            UndoInfo undo = m_position.makeMove(move_list[i]);
-            if (m_position.isLegal<false>()) [[likely]] {
-                uint64_t child_nodes = perft<false>(depth - 1, move_list + size);
+        m_workers[0]->search(m_root_position, m_root_keys, m_search_parameters);
 
-                if constexpr (Root) {
-                    std::cout << move_list[i].toString() << ": " << child_nodes << '\n';
-                }
+        // the main worker is done, by its depth limit or by the clock, and the helpers stop with it
+        m_stop_search = true;
+        for (size_t i = 1; i < m_threads.size(); ++i) m_threads[i]->wait();
 
-                nodes += child_nodes;
-            }
-            m_position.unmakeMove(move_list[i], undo);
+        // mate or stalemate at the root, the workers had nothing to search
+        if (m_workers[0]->rootMoves().empty()) {
+            std::cout << "bestmove (none)" << std::endl;
+            return;
+        }
+
+        uint64_t nodes  = 0;
+        uint64_t qnodes = 0;
+        for (const auto& worker : m_workers) {
+            nodes += worker->nodes();
+            qnodes += worker->qnodes();
+        }
+
+        const int64_t  elapsed = m_time.elapsed();
+        const uint64_t nps     = nodes * 1000 / static_cast<uint64_t>(std::max<int64_t>(elapsed, 1));
+        std::cout << "info nodes " << nodes << " nps " << nps << " time " << elapsed << " hashfull " << m_tt.hashfull()
+                  << std::endl;
+        std::cout << "info string qnodes " << qnodes << " (" << (nodes == 0 ? 0 : qnodes * 100 / nodes)
+                  << "% of nodes)" << std::endl;
+
+        const SearchWorker& best = bestWorker();
+        if (&best != m_workers[0].get()) best.printBestLine();
+        std::cout << "bestmove " << best.bestMove().toString() << std::endl;
+    }
+
+    // every worker votes for its move, weighted by the depth it completed and by how far its score is above the
+    // worst one. the main worker comes first and keeps ties, its line is the one the gui has already been shown
+    [[nodiscard]] const SearchWorker& bestWorker() const {
+        int min_score = Evaluation::MATE_SCORE;
+        for (const auto& worker : m_workers) {
+            if (worker->completedDepth() > 0) min_score = std::min(min_score, worker->bestScore());
         }
 
-        return nodes;
+        const SearchWorker* best       = m_workers[0].get();
+        int64_t             best_votes = -1;
+        for (const auto& candidate : m_workers) {
+            if (candidate->completedDepth() == 0) continue;
+
+            int64_t votes = 0;
+            for (const auto& voter : m_workers) {
+                if (voter->completedDepth() > 0 && voter->bestMove() == candidate->bestMove())
+                    votes += static_cast<int64_t>(voter->bestScore() - min_score + 14) * voter->completedDepth();
+            }
+            if (votes > best_votes) {
+                best_votes = votes;
+                best       = candidate.get();
+            }
+        }
+        return *best;
     }
 
-    Move m_best_move{};
-    Move m_current_best_move{};
-    int  m_current_depth{};
-    int  m_current_eval{};
+    Position m_position{};
+
+    TranspositionTable m_tt{};
 
-    std::thread                           m_search_thread{};
-    std::atomic<bool>                     m_stop_search{};
-    std::chrono::steady_clock::time_point m_start_time{};
+    SearchOptions         m_options{};
+    SearchWorker::Workers m_workers{};
+
+    History m_history{};
+
+    // thread i runs worker i, the first one also runs the search started by go()
+    std::vector<std::unique_ptr<SearchThread>> m_threads{};
+    std::atomic<bool>                          m_stop_search{};
+
+    Position         m_root_position{};
+    std::vector<Key> m_root_keys{};  // the game before the root position, for repetitions
+    SearchParameters m_search_parameters{};
+    TimeManager      m_time{};
+    int              m_move_overhead_ms{TimeManager::DEFAULT_MOVE_OVERHEAD_MS};
 
     int m_search_max_time_ms{-1};
 
     bool              m_moves_dirty{true};
     std::vector<Move> m_moves_cache{};
-
-    int      m_allocated_time{-1};
-    uint64_t m_nodes{};
 };
\ No newline at end of file
@@ -1,14 +1,17 @@
 #include "move.hpp"
 #include "undo_info.hpp"
+#include "zobrist.hpp"
 
 struct HistoryEntry {
     Move     move;
     UndoInfo undo_info;
+    Key      key;  // of the position the move was played in
 };
 
 class History {
    public:
-    void push(Move move, UndoInfo undo_info) { m_entries.push_back({move, undo_info}); }
+    void push(Move move, UndoInfo undo_info, Key key) { m_entries.push_back({move, undo_info, key}); }
+    void clear() { m_entries.clear(); }
 
     HistoryEntry pop() {
         if (m_entries.empty()) return {};
@@ -25,6 +28,16 @@ class History {
 
         return moves;
     }
+    // oldest first, the last one is the position before the current one
+    [[nodiscard]] std::vector<Key> getKeyHistory() const {
+        std::vector<Key> keys;
+        keys.reserve(m_entries.size());
+
+        std::ranges::transform(m_entries, std::back_inserter(keys),
+                               [](const HistoryEntry& entry) { return entry.key; });
+
+        return keys;
+    }
 
    private:
     std::vector<HistoryEntry> m_entries{};
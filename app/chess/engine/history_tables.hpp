@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+#include "color.hpp"
+#include "move.hpp"
+#include "piece.hpp"
+#include "piece_type.hpp"
+#include "square.hpp"
+
+namespace HistoryTables {
+inline constexpr int MAX = 16384;
+
+// pieces are indexed by their raw value, which skips the color/type split
+inline constexpr size_t PIECE_SLOTS = 1 << (Color::width() + PieceType::width());
+
+// gravity: the further an entry already is from zero, the less the same bonus moves it, so it never leaves [-MAX, MAX]
+constexpr void update(int16_t& entry, int bonus) {
+    bonus = std::clamp(bonus, -MAX, MAX);
+    entry = static_cast<int16_t>(entry + bonus - entry * std::abs(bonus) / MAX);
+}
+
+constexpr int bonus(int depth) { return std::min(150 * depth - 100, 1600); }
+};  // namespace HistoryTables
+
+// quiet move history by [color][from][to]
+class ButterflyHistory {
+   public:
+    [[nodiscard]] int get(Color color, Move move) const {
+        return m_table[color.value()][move.from().value()][move.to().value()];
+    }
+
+    void update(Color color, Move move, int bonus) {
+        HistoryTables::update(m_table[color.value()][move.from().value()][move.to().value()], bonus);
+    }
+
+    // keeps a fraction of what was learned, older results weigh less against the new ones
+    void age(int numerator, int denominator) {
+        for (auto& from : m_table) {
+            for (auto& to : from) {
+                for (auto& entry : to) entry = static_cast<int16_t>(entry * numerator / denominator);
+            }
+        }
+    }
+
+    void clear() { m_table = {}; }
+
+   private:
+    std::array<std::array<std::array<int16_t, Squares::count()>, Squares::count()>, Colors::count()> m_table{};
+};
+
+// capture history by [moving piece][to][captured type]
+class CaptureHistory {
+   public:
+    [[nodiscard]] int get(Piece piece, Square to, PieceType captured) const {
+        return m_table[piece.value()][to.value()][captured.value()];
+    }
+
+    void update(Piece piece, Square to, PieceType captured, int bonus) {
+        HistoryTables::update(m_table[piece.value()][to.value()][captured.value()], bonus);
+    }
+
+    void age(int numerator, int denominator) {
+        for (auto& piece : m_table) {
+            for (auto& to : piece) {
+                for (auto& entry : to) entry = static_cast<int16_t>(entry * numerator / denominator);
+            }
+        }
+    }
+
+    void clear() { m_table = {}; }
+
+   private:
+    std::array<std::array<std::array<int16_t, PieceTypes::count()>, Squares::count()>, HistoryTables::PIECE_SLOTS>
+        m_table{};
+};
+
+// quiet history by [piece][to], one row of the continuation history
+using PieceToHistory = std::array<std::array<int16_t, Squares::count()>, HistoryTables::PIECE_SLOTS>;
+
+// quiet history of (piece, to) after an earlier move (piece, to) of the same line. the same table serves one and two
+// plies back, the moving pieces are of different colors there so the entries never mix
+class ContinuationHistory {
+   public:
+    ContinuationHistory() : m_table(std::make_unique<Table>()) {}
+
+    [[nodiscard]] PieceToHistory& row(Piece piece, Square to) { return (*m_table)[piece.value()][to.value()]; }
+
+    static int get(const PieceToHistory& row, Piece piece, Square to) { return row[piece.value()][to.value()]; }
+    static void update(PieceToHistory& row, Piece piece, Square to, int bonus) {
+        HistoryTables::update(row[piece.value()][to.value()], bonus);
+    }
+
+    void age(int numerator, int denominator) {
+        for (auto& piece : *m_table) {
+            for (auto& to : piece) {
+                for (auto& pieces : to) {
+                    for (auto& entry : pieces) entry = static_cast<int16_t>(entry * numerator / denominator);
+                }
+            }
+        }
+    }
+
+    void clear() { *m_table = {}; }
+
+   private:
+    // two megabytes, too much to live inside the engine object
+    using Table = std::array<std::array<PieceToHistory, Squares::count()>, HistoryTables::PIECE_SLOTS>;
+
+    std::unique_ptr<Table> m_table{};
+};
+
+// the quiet move that last refuted a move, by the refuted move's [piece][to]
+class CounterMoves {
+   public:
+    [[nodiscard]] Move get(Piece piece, Square to) const { return m_table[piece.value()][to.value()]; }
+    void               set(Piece piece, Square to, Move move) { m_table[piece.value()][to.value()] = move; }
+
+    void clear() { m_table = {}; }
+
+   private:
+    std::array<std::array<Move, Squares::count()>, HistoryTables::PIECE_SLOTS> m_table{};
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "bit_operations.hpp"
+#include "color.hpp"
+#include "endgame.hpp"
+#include "piece_type.hpp"
+#include "position.hpp"
+#include "psqt.hpp"
+#include "score.hpp"
+#include "zobrist.hpp"
+
+// everything the piece counts decide on their own, the scores from white's side
+struct MaterialEntry {
+    static constexpr int SCALE_NORMAL = 64;
+
+    Key   key{};
+    int   phase{};  // Psqt::MAX_PHASE with all pieces on, never more
+    Score imbalance{};
+
+    // applied to the endgame half when the color is the one ahead, lower where its material is not enough to win
+    std::array<uint8_t, Colors::count()> scale{SCALE_NORMAL, SCALE_NORMAL};
+
+    // replaces the general evaluation in the endgames it knows better
+    Endgames::Function evaluator{};
+    Color              strong{};
+};
+
+// one per search thread like the pawn table. the counts change even less often than the pawns
+class MaterialTable {
+   public:
+    static constexpr size_t SIZE = 4096;
+
+    MaterialTable() : m_entries(std::make_unique<Entries>()) {}
+
+    // the entry for the piece counts of the position, worked out on a miss
+    const MaterialEntry& probe(const Position& position) {
+        // the kings are counted as well, a real key is never zero
+        MaterialEntry& entry = (*m_entries)[position.materialKey() & (SIZE - 1)];
+        if (entry.key == position.materialKey()) return entry;
+
+        entry     = MaterialEntry{};
+        entry.key = position.materialKey();
+        fill(position, entry);
+        return entry;
+    }
+
+   private:
+    static constexpr Score BISHOP_PAIR = Score(30, 50);
+
+    static int count(const Position& position, Color color, PieceType type) {
+        return popcount(position.occupancy(color, type));
+    }
+
+    // midgame value of the pieces other than pawns and the king
+    static int nonPawnMaterial(const Position& position, Color color) {
+        int material = 0;
+        for (const PieceType type : {PieceTypes::KNIGHT, PieceTypes::BISHOP, PieceTypes::ROOK, PieceTypes::QUEEN})
+            material += count(position, color, type) * Psqt::PIECE_VALUE[type.value()].midgame();
+        return material;
+    }
+
+    static void fill(const Position& position, MaterialEntry& entry) {
+        for (const PieceType type : PieceTypes::all()) {
+            const int pieces = count(position, Colors::WHITE, type) + count(position, Colors::BLACK, type);
+            entry.phase += pieces * Psqt::PHASE_WEIGHT[type.value()];
+        }
+        entry.phase = std::min(entry.phase, Psqt::MAX_PHASE);
+
+        const int bishop = Psqt::PIECE_VALUE[PieceTypes::BISHOP.value()].midgame();
+        const int rook   = Psqt::PIECE_VALUE[PieceTypes::ROOK.value()].midgame();
+
+        std::array<int, Colors::count()> material{};
+        std::array<int, Colors::count()> pawns{};
+        for (const Color color : Colors::all()) {
+            material[color.value()] = nonPawnMaterial(position, color);
+            pawns[color.value()]    = count(position, color, PieceTypes::PAWN);
+        }
+
+        // at most one minor piece and no pawns, or two knights against the bare king: no mate can be forced
+        const bool no_pawns = pawns[0] + pawns[1] == 0;
+        if (no_pawns && material[0] + material[1] <= bishop) {
+            entry.evaluator = &Endgames::draw;
+            return;
+        }
+
+        for (const Color strong : Colors::all()) {
+            const Color weak = !strong;
+            if (pawns[weak.value()] != 0 || material[weak.value()] != 0) continue;
+
+            if (pawns[strong.value()] == 0 && count(position, strong, PieceTypes::KNIGHT) == 2 &&
+                material[strong.value()] == 2 * Psqt::PIECE_VALUE[PieceTypes::KNIGHT.value()].midgame()) {
+                entry.evaluator = &Endgames::draw;
+                return;
+            }
+            if (pawns[strong.value()] == 0 && count(position, strong, PieceTypes::KNIGHT) == 1 &&
+                count(position, strong, PieceTypes::BISHOP) == 1 &&
+                material[strong.value()] == Psqt::PIECE_VALUE[PieceTypes::KNIGHT.value()].midgame() + bishop) {
+                entry.evaluator = &Endgames::mateBishopKnight;
+                entry.strong    = strong;
+                return;
+            }
+            if (pawns[strong.value()] == 0 && count(position, strong, PieceTypes::BISHOP) >= 2 &&
+                material[strong.value()] == count(position, strong, PieceTypes::BISHOP) * bishop) {
+                entry.evaluator = &Endgames::mateBishops;
+                entry.strong    = strong;
+                return;
+            }
+            if (material[strong.value()] >= rook) {
+                entry.evaluator = &Endgames::mateBareKing;
+                entry.strong    = strong;
+                return;
+            }
+        }
+
+        for (const Color color : Colors::all()) {
+            if (count(position, color, PieceTypes::BISHOP) >= 2)
+                entry.imbalance += color == Colors::WHITE ? BISHOP_PAIR : -BISHOP_PAIR;
+
+            // without pawns, a lead of a minor piece or less is rarely enough
+            const int ours   = material[color.value()];
+            const int theirs = material[(!color).value()];
+            if (pawns[color.value()] == 0 && ours - theirs <= bishop)
+                entry.scale[color.value()] = ours < rook ? 0 : theirs <= bishop ? 4 : 14;
+        }
+    }
+
+    using Entries = std::array<MaterialEntry, SIZE>;
+
+    std::unique_ptr<Entries> m_entries{};
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "evaluation.hpp"
+#include "history_tables.hpp"
+#include "move.hpp"
+#include "position.hpp"
+#include "search_stack.hpp"
+
+enum class PickStage : uint8_t {
+    HASH,
+    CAPTURES_INIT,
+    GOOD_CAPTURES,
+    KILLERS,
+    COUNTER_MOVE,
+    QUIETS_INIT,
+    QUIETS,
+    BAD_CAPTURES,
+    DONE
+};
+
+// hands out the moves of a node one at a time, best guesses first. every stage is generated and scored only when
+// reached, so a cutoff on the hash move or a capture never pays for the quiet moves. the lists live in the frame of
+// the node
+class MovePicker {
+   public:
+    using Continuations = std::array<const PieceToHistory*, 2>;  // one and two plies back, null where there is none
+
+    MovePicker(Position& position, SearchFrame& frame, Move hash_move, Move counter_move,
+               const ButterflyHistory& history, const CaptureHistory& capture_history,
+               const Continuations& continuations)
+        : m_position(position),
+          m_moves(frame.moves),
+          m_scores(frame.scores),
+          m_hash_move(hash_move),
+          m_killers(frame.killers),
+          m_counter_move(counter_move),
+          m_history(history),
+          m_capture_history(capture_history),
+          m_continuations(continuations) {}
+
+    // an empty move once every stage is exhausted
+    Move next() {
+        switch (m_stage) {
+            case PickStage::HASH:
+                m_stage = PickStage::CAPTURES_INIT;
+                if (m_position.isLegalMove(m_hash_move)) return m_hash_move;
+                [[fallthrough]];
+
+            case PickStage::CAPTURES_INIT:
+                m_end = m_position.generateMoves<GenerationTypes::CAPTURES>(m_moves.data());
+                for (size_t i = 0; i < m_end; ++i) m_scores[i] = scoreCapture(m_moves[i]);
+                m_stage = PickStage::GOOD_CAPTURES;
+                [[fallthrough]];
+
+            case PickStage::GOOD_CAPTURES:
+                while (m_current < m_end) {
+                    const Move move = selectBest();
+                    if (move == m_hash_move) continue;
+
+                    // the slots before the cursor are free again, so the losing captures are parked there
+                    if (isBadCapture(move)) {
+                        m_moves[m_bad_end++] = move;
+                        continue;
+                    }
+                    return move;
+                }
+                m_stage = PickStage::KILLERS;
+                [[fallthrough]];
+
+            case PickStage::KILLERS:
+                while (m_killer < m_killers.size()) {
+                    const Move move = m_killers[m_killer++];
+                    if (move != m_hash_move && isQuiet(move) && m_position.isLegalMove(move)) return move;
+                }
+                m_stage = PickStage::COUNTER_MOVE;
+                [[fallthrough]];
+
+            case PickStage::COUNTER_MOVE:
+                m_stage = PickStage::QUIETS_INIT;
+
+                // ahead of the other quiets only when the histories agree, otherwise it is ranked among them
+                if (m_counter_move != m_hash_move && m_counter_move != m_killers[0] && m_counter_move != m_killers[1] &&
+                    isQuiet(m_counter_move) && m_position.isLegalMove(m_counter_move) &&
+                    scoreQuiet(m_counter_move) >= 0)
+                    return m_counter_move;
+                m_counter_move = Move{};
+                [[fallthrough]];
+
+            case PickStage::QUIETS_INIT:
+                m_current = m_end;
+                m_end += m_position.generateMoves<GenerationTypes::QUIETS>(m_moves.data() + m_end);
+                for (size_t i = m_current; i < m_end; ++i) m_scores[i] = scoreQuiet(m_moves[i]);
+                m_stage = PickStage::QUIETS;
+                [[fallthrough]];
+
+            case PickStage::QUIETS:
+                while (m_current < m_end) {
+                    const Move move = selectBest();
+                    if (move == m_hash_move || move == m_killers[0] || move == m_killers[1] || move == m_counter_move)
+                        continue;
+                    return move;
+                }
+                m_current = 0;
+                m_stage   = PickStage::BAD_CAPTURES;
+                [[fallthrough]];
+
+            case PickStage::BAD_CAPTURES:
+                if (m_current < m_bad_end) return m_moves[m_current++];
+                m_stage = PickStage::DONE;
+                [[fallthrough]];
+
+            case PickStage::DONE:
+                break;
+        }
+        return Move{};
+    }
+
+    static PieceType capturedType(const Position& position, Move move) {
+        return move.flag() == MoveFlags::EN_PASSANT ? PieceTypes::PAWN : position.at(move.to()).type();
+    }
+
+    // most valuable victim first, the least valuable attacker breaks ties. promotions count the new piece too
+    static int mvvLva(const Position& position, Move move) {
+        int score = 0;
+        if (position.isCapture(move))
+            score += 10 * Evaluation::pieceValue(capturedType(position, move)) -
+                     Evaluation::pieceValue(position.at(move.from()).type());
+        if (move.isPromotion()) score += 10 * Evaluation::pieceValue(move.promotionType());
+        return score;
+    }
+
+   private:
+    // the history only reorders captures of the same victim, it is too small to jump a whole victim class
+    [[nodiscard]] int scoreCapture(Move move) const {
+        int score = mvvLva(m_position, move);
+        if (m_position.isCapture(move))
+            score += m_capture_history.get(m_position.at(move.from()), move.to(), capturedType(m_position, move)) / 16;
+        return score;
+    }
+
+    [[nodiscard]] int scoreQuiet(Move move) const {
+        const Piece piece = m_position.at(move.from());
+
+        int score = m_history.get(m_position.us(), move);
+        for (const PieceToHistory* continuation : m_continuations) {
+            if (continuation != nullptr) score += ContinuationHistory::get(*continuation, piece, move.to());
+        }
+        return score;
+    }
+
+    // selection instead of a full sort, most nodes cut off long before the list is through
+    Move selectBest() {
+        size_t best = m_current;
+        for (size_t i = m_current + 1; i < m_end; ++i) {
+            if (m_scores[i] > m_scores[best]) best = i;
+        }
+        std::swap(m_moves[m_current], m_moves[best]);
+        std::swap(m_scores[m_current], m_scores[best]);
+        return m_moves[m_current++];
+    }
+
+    [[nodiscard]] bool isQuiet(Move move) const {
+        return move.hasValue() && !m_position.isCapture(move) && !move.isPromotion();
+    }
+
+    // one that loses material once every recapture is played out, promotions are never put back
+    [[nodiscard]] bool isBadCapture(Move move) const { return !m_position.see(move, 0); }
+
+    Position&               m_position;
+    SearchFrame::MoveList&  m_moves;
+    SearchFrame::ScoreList& m_scores;
+    Move                    m_hash_move;
+    Killers                 m_killers;
+    Move                    m_counter_move;
+    const ButterflyHistory& m_history;
+    const CaptureHistory&   m_capture_history;
+    Continuations           m_continuations;
+
+    PickStage m_stage{PickStage::HASH};
+
+    size_t m_current{};
+    size_t m_end{};
+    size_t m_bad_end{};
+    size_t m_killer{};
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "bit_operations.hpp"
+#include "bitboard.hpp"
+#include "color.hpp"
+#include "piece_type.hpp"
+#include "position.hpp"
+#include "score.hpp"
+#include "square.hpp"
+#include "zobrist.hpp"
+
+// everything the pawns decide on their own, the scores from white's side. the shelter also depends on where the
+// king stands and is kept for the square it was last worked out for
+struct PawnEntry {
+    Key   key{};  // a zero key has no pawns, and an empty entry is already right for it
+    Score score{};
+
+    std::array<Square, Colors::count()> king_square{Squares::NONE, Squares::NONE};
+    std::array<Score, Colors::count()>  shelter{};
+};
+
+// one per search thread, so it needs no locking. the pawns change in few of the moves searched, nearly every
+// probe finds its entry
+class PawnTable {
+   public:
+    static constexpr size_t SIZE = 8192;
+
+    PawnTable() : m_entries(std::make_unique<Entries>()) {}
+
+    // the entry for the pawns of the position, worked out on a miss
+    PawnEntry& probe(const Position& position) {
+        ++m_probes;
+
+        PawnEntry& entry = (*m_entries)[position.pawnKey() & (SIZE - 1)];
+        if (entry.key == position.pawnKey()) {
+            ++m_hits;
+            return entry;
+        }
+
+        entry       = PawnEntry{};
+        entry.key   = position.pawnKey();
+        entry.score = evaluate(position, Colors::WHITE) - evaluate(position, Colors::BLACK);
+        return entry;
+    }
+
+    // own pawns on the three files around the king, worth more the closer they stand
+    static Score shelter(const Position& position, Color color, PawnEntry& entry) {
+        const Square king = lsb(position.occupancy(color, PieceTypes::KING));
+        if (entry.king_square[color.value()] == king) return entry.shelter[color.value()];
+
+        const Bitboard pawns = position.occupancy(color, PieceTypes::PAWN);
+        const int      file  = king.file().value();
+        const int      rank  = king.rank().value();
+        const int      ahead = color == Colors::WHITE ? 1 : -1;
+
+        Score shelter{};
+        for (int f = std::max(file - 1, 0); f <= std::min(file + 1, 7); ++f) {
+            for (int distance = 1; distance <= 2; ++distance) {
+                const int r = rank + ahead * distance;
+                if (r < 0 || r > 7) break;
+
+                const Square square(static_cast<uint8_t>(r * 8 + f));
+                if (pawns.test(square)) {
+                    shelter += SHELTER[static_cast<size_t>(distance)];
+                    break;
+                }
+            }
+        }
+
+        entry.king_square[color.value()] = king;
+        entry.shelter[color.value()]     = shelter;
+        return shelter;
+    }
+
+    [[nodiscard]] uint64_t probes() const { return m_probes; }
+    [[nodiscard]] uint64_t hits() const { return m_hits; }
+    void                   resetCounters() { m_probes = m_hits = 0; }
+
+   private:
+    static constexpr Score DOUBLED  = Score(-10, -20);
+    static constexpr Score ISOLATED = Score(-8, -12);
+    static constexpr Score BACKWARD = Score(-6, -10);
+
+    static constexpr std::array<Score, 3> SHELTER = {Score(0, 0), Score(15, 0), Score(8, 0)};
+
+    // by the rank counted from the pawn's own side
+    static constexpr std::array<Score, 8> PASSED = {Score(0, 0),   Score(0, 5),   Score(5, 10),   Score(10, 20),
+                                                    Score(20, 40), Score(40, 70), Score(60, 110), Score(0, 0)};
+
+    static constexpr Bitboard NOT_FILE_A = ~Bitboard(0x0101010101010101ULL);
+    static constexpr Bitboard NOT_FILE_H = ~Bitboard(0x8080808080808080ULL);
+
+    static constexpr Bitboard forward(Bitboard bitboard, Color color) {
+        return color == Colors::WHITE ? bitboard << 8 : bitboard >> 8;
+    }
+    static constexpr Bitboard fillForward(Bitboard bitboard, Color color) {
+        for (const unsigned shift : {8U, 16U, 32U})
+            bitboard |= color == Colors::WHITE ? bitboard << shift : bitboard >> shift;
+        return bitboard;
+    }
+    static constexpr Bitboard fillFiles(Bitboard bitboard) {
+        return fillForward(bitboard, Colors::WHITE) | fillForward(bitboard, Colors::BLACK);
+    }
+    static constexpr Bitboard sideways(Bitboard bitboard) {
+        return ((bitboard & NOT_FILE_H) << 1) | ((bitboard & NOT_FILE_A) >> 1);
+    }
+
+    // the structure of one color
+    static Score evaluate(const Position& position, Color color) {
+        const Bitboard ours   = position.occupancy(color, PieceTypes::PAWN);
+        const Bitboard theirs = position.occupancy(!color, PieceTypes::PAWN);
+
+        const Bitboard attacks       = forward(sideways(ours), color);
+        const Bitboard their_attacks = forward(sideways(theirs), !color);
+        const Bitboard attack_span   = fillForward(attacks, color);
+
+        // a pawn is passed when no enemy pawn stands ahead of it on its own or a neighbouring file
+        const Bitboard their_front = fillForward(forward(theirs, !color), !color);
+        const Bitboard passed      = ours & ~(their_front | fillForward(their_attacks, !color));
+
+        const Bitboard doubled  = ours & fillForward(forward(ours, color), color);
+        const Bitboard isolated = ours & ~sideways(fillFiles(ours));
+
+        // the square in front is attacked by an enemy pawn, and no own pawn can ever come to cover it
+        const Bitboard stops    = forward(ours, color) & their_attacks & ~attack_span;
+        const Bitboard backward = forward(stops, !color) & ~isolated;
+
+        Score score = DOUBLED * popcount(doubled) + ISOLATED * popcount(isolated) + BACKWARD * popcount(backward);
+        for (Bitboard remaining = passed; remaining.any();) {
+            const int rank = poplsb(remaining).rank().value();
+            score += PASSED[static_cast<size_t>(color == Colors::WHITE ? rank : 7 - rank)];
+        }
+        return score;
+    }
+
+    using Entries = std::array<PawnEntry, SIZE>;
+
+    std::unique_ptr<Entries> m_entries{};
+
+    uint64_t m_probes{};
+    uint64_t m_hits{};
+};
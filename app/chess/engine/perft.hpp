@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "move.hpp"
+#include "perft_table.hpp"
+#include "position.hpp"
+#include "undo_info.hpp"
+
+class Perft {
+   public:
+    static constexpr size_t MAX_MOVES = 256;
+    static constexpr int    MAX_DEPTH = 64;
+
+    using Divide = std::vector<std::pair<Move, uint64_t>>;
+
+    // node counts below every root move, in generation order regardless of the thread count
+    static Divide divide(const Position& root, int depth, PerftTable* table, size_t threads) {
+        if (depth <= 0) return {};
+
+        Position          position = root;
+        std::vector<Move> move_stack(MAX_MOVES * MAX_DEPTH);
+
+        const size_t size = position.generateMoves<GenerationTypes::LEGAL>(move_stack.data());
+
+        Divide result;
+        result.reserve(size);
+        for (size_t i = 0; i < size; ++i) result.emplace_back(move_stack[i], 0);
+
+        if (threads > 1 && depth > 2) {
+            divideParallel(position, depth, table, threads, result);
+            return result;
+        }
+
+        for (auto& [move, nodes] : result) {
+            UndoInfo undo = position.makeMove(move);
+            nodes         = count(position, depth - 1, move_stack.data() + size, table);
+            position.unmakeMove(move, undo);
+        }
+        return result;
+    }
+
+    static uint64_t count(Position& position, int depth, Move* move_list, PerftTable* table) {
+        if (depth == 0) return 1;
+
+        if (table != nullptr && depth > 1) {
+            if (uint64_t cached = table->probe(position.key(), depth)) return cached;
+        }
+
+        size_t size = position.generateMoves<GenerationTypes::LEGAL>(move_list);
+
+        // the generator is fully legal, so the leaves don't have to be visited
+        if (depth == 1) return size;
+
+        uint64_t nodes = 0;
+
+        for (size_t i = 0; i < size; ++i) {
+            UndoInfo undo = position.makeMove(move_list[i]);
+            nodes += count(position, depth - 1, move_list + size, table);
+            position.unmakeMove(move_list[i], undo);
+        }
+
+        if (table != nullptr) table->store(position.key(), depth, nodes);
+
+        return nodes;
+    }
+
+   private:
+    // one task per (root move, reply) pair
+    struct Task {
+        size_t root{};
+        Move   root_move{};
+        Move   reply{};
+    };
+
+    struct alignas(64) Worker {
+        std::mutex         mutex{};
+        std::deque<size_t> tasks{};
+    };
+
+    static void divideParallel(Position& position, int depth, PerftTable* table, size_t threads, Divide& result) {
+        std::vector<Task> tasks;
+        std::vector<Move> replies(MAX_MOVES);
+
+        for (size_t i = 0; i < result.size(); ++i) {
+            const Move root_move = result[i].first;
+
+            UndoInfo     undo = position.makeMove(root_move);
+            const size_t size = position.generateMoves<GenerationTypes::LEGAL>(replies.data());
+            for (size_t j = 0; j < size; ++j) tasks.push_back({i, root_move, replies[j]});
+            position.unmakeMove(root_move, undo);
+        }
+
+        threads = std::clamp<size_t>(threads, 1, std::max<size_t>(tasks.size(), 1));
+
+        std::vector<Worker> workers(threads);
+        for (size_t i = 0; i < tasks.size(); ++i) workers[i % threads].tasks.push_back(i);
+
+        std::vector<uint64_t> task_nodes(tasks.size());
+
+        auto work = [&](size_t id) {
+            Position          local = position;
+            std::vector<Move> move_stack(MAX_MOVES * MAX_DEPTH);
+
+            size_t task = 0;
+            while (popTask(workers, id, task)) {
+                const Task& t = tasks[task];
+
+                UndoInfo root_undo  = local.makeMove(t.root_move);
+                UndoInfo reply_undo = local.makeMove(t.reply);
+                task_nodes[task]    = count(local, depth - 2, move_stack.data(), table);
+                local.unmakeMove(t.reply, reply_undo);
+                local.unmakeMove(t.root_move, root_undo);
+            }
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (size_t id = 1; id < threads; ++id) pool.emplace_back(work, id);
+        work(0);
+        for (auto& thread : pool) thread.join();
+
+        for (size_t i = 0; i < tasks.size(); ++i) result[tasks[i].root].second += task_nodes[i];
+    }
+
+    // takes from the back of the own queue, steals from the front of the others once it runs dry
+    static bool popTask(std::vector<Worker>& workers, size_t id, size_t& task) {
+        {
+            Worker&                     own = workers[id];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+
+        for (size_t offset = 1; offset < workers.size(); ++offset) {
+            Worker&                     victim = workers[(id + offset) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "zobrist.hpp"
+
+// memoizes perft subtree counts by (position key, depth)
+class PerftTable {
+   public:
+    explicit PerftTable(size_t size_mb) {
+        const size_t count = std::bit_floor(std::max<size_t>(size_mb, 1) * 1024 * 1024 / sizeof(Entry));
+
+        m_entries = std::make_unique<Entry[]>(count);
+        m_mask    = count - 1;
+    }
+
+    // a zero count means a miss, a subtree that is really empty is cheap to count again anyway
+    [[nodiscard]] uint64_t probe(Key key, int depth) const {
+        const Entry&   entry = m_entries[index(key, depth)];
+        const uint64_t data  = entry.data.load(std::memory_order_relaxed);
+
+        if ((entry.check.load(std::memory_order_relaxed) ^ data) != key) return 0;
+        if ((data & DEPTH_MASK) != static_cast<uint64_t>(depth)) return 0;
+        return data >> DEPTH_BITS;
+    }
+
+    void store(Key key, int depth, uint64_t nodes) {
+        Entry&         entry = m_entries[index(key, depth)];
+        const uint64_t data  = nodes << DEPTH_BITS | static_cast<uint64_t>(depth);
+
+        // the key is stored xor-ed with the data, so a torn write from another thread fails the check
+        entry.check.store(key ^ data, std::memory_order_relaxed);
+        entry.data.store(data, std::memory_order_relaxed);
+    }
+
+   private:
+    static constexpr int      DEPTH_BITS = 8;
+    static constexpr uint64_t DEPTH_MASK = (1ULL << DEPTH_BITS) - 1;
+    // spreads the depths of one position over different slots
+    static constexpr uint64_t DEPTH_SALT = 0x9E3779B97F4A7C15ULL;
+
+    struct Entry {
+        std::atomic<uint64_t> check{};
+        std::atomic<uint64_t> data{};
+    };
+
+    [[nodiscard]] size_t index(Key key, int depth) const {
+        return (key ^ (static_cast<uint64_t>(depth) * DEPTH_SALT)) & m_mask;
+    }
+
+    std::unique_ptr<Entry[]> m_entries{};
+    size_t                   m_mask{};
+};
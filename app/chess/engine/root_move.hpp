@@ -0,0 +1,23 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "evaluation.hpp"
+#include "move.hpp"
+#include "search_stack.hpp"
+
+// a legal move of the root position with what the last searches found out about it
+struct RootMove {
+    Move move{};
+
+    // exact only for moves that raised alpha, the others stay at -MATE_SCORE and keep their place in the order
+    int score{-Evaluation::MATE_SCORE};
+    int previous_score{-Evaluation::MATE_SCORE};
+
+    uint64_t nodes{};  // spent below this move in the current iteration
+
+    std::array<Move, SearchFrame::MAX_PLY> pv{};
+    size_t                                 pv_length{};
+};
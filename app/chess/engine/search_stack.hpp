@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+#include "history_tables.hpp"
+#include "move.hpp"
+#include "piece.hpp"
+#include "zobrist.hpp"
+
+using Killers = std::array<Move, 2>;
+
+// everything a node at one ply needs. the storage is allocated once and reused, nodes overwrite what they read
+struct SearchFrame {
+    static constexpr int    MAX_PLY   = 128;
+    static constexpr size_t MAX_MOVES = 256;
+
+    using MoveList  = std::array<Move, MAX_MOVES>;
+    using ScoreList = std::array<int, MAX_MOVES>;
+
+    // the move played from this ply, set just before it is made
+    Move            move{};
+    Piece           piece{Pieces::NONE};  // stays NONE for a null move
+    PieceToHistory* continuation{};       // the continuation row of (piece, to), null for a null move
+
+    Killers killers{};
+    int     static_eval{};
+    Key     key{};  // of the position at this ply, for repetitions
+
+    MoveList             moves{};
+    ScoreList            scores{};
+    std::array<Move, 64> quiets_tried{};
+    std::array<Move, 32> captures_tried{};
+
+    // one row of the triangular pv table: the best line found from this ply, the child's row with the move in front
+    std::array<Move, MAX_PLY> pv{};
+    size_t                    pv_length{};
+};
+
+// frames of the line being searched, indexed by ply. a few empty frames sit before the root, so looking back from
+// the first plies needs no bounds checks
+class SearchStack {
+   public:
+    static constexpr int MAX_PLY = SearchFrame::MAX_PLY;
+
+    SearchStack() : m_frames(std::make_unique<Frames>()) {}
+
+    SearchFrame& operator[](int ply) {
+        assert(ply >= -LOOKBACK && ply < MAX_PLY);
+        return (*m_frames)[static_cast<size_t>(ply + LOOKBACK)];
+    }
+    const SearchFrame& operator[](int ply) const {
+        assert(ply >= -LOOKBACK && ply < MAX_PLY);
+        return (*m_frames)[static_cast<size_t>(ply + LOOKBACK)];
+    }
+
+    void clearKillers() {
+        for (auto& frame : *m_frames) frame.killers = {};
+    }
+
+   private:
+    static constexpr int LOOKBACK = 2;
+
+    // a few hundred kilobytes, kept off the stack of whichever thread owns the engine
+    using Frames = std::array<SearchFrame, MAX_PLY + LOOKBACK>;
+
+    std::unique_ptr<Frames> m_frames{};
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// a thread parked on a condition variable between searches. a search wakes it up instead of creating a thread, and
+// the stack and caches it has warmed up are still there for the next one
+class SearchThread {
+   public:
+    SearchThread() : m_thread(&SearchThread::idleLoop, this) {}
+    ~SearchThread() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_exit = true;
+        }
+        m_wake.notify_all();
+        m_thread.join();
+    }
+
+    SearchThread(const SearchThread&)            = delete;
+    SearchThread& operator=(const SearchThread&) = delete;
+
+    // the thread has to be idle. a job capturing no more than two pointers is stored without allocating
+    void start(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job  = std::move(job);
+            m_busy = true;
+        }
+        m_wake.notify_all();
+    }
+
+    // blocks until the current job, if there is one, is done
+    void wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [this] { return !m_busy; });
+    }
+
+   private:
+    void idleLoop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_wake.wait(lock, [this] { return m_busy || m_exit; });
+            if (m_exit) return;
+
+            lock.unlock();
+            m_job();
+            lock.lock();
+
+            m_busy = false;
+            m_wake.notify_all();
+        }
+    }
+
+    std::mutex              m_mutex{};
+    std::condition_variable m_wake{};  // both ways: a job for the thread, and the end of it for whoever waits
+    std::function<void()>   m_job{};
+    bool                    m_busy{};
+    bool                    m_exit{};
+
+    // last, the loop must not start before the members above exist
+    std::thread m_thread;
+};
@@ -0,0 +1,785 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "cuckoo.hpp"
+#include "evaluation.hpp"
+#include "history_tables.hpp"
+#include "move.hpp"
+#include "material_table.hpp"
+#include "move_picker.hpp"
+#include "pawn_table.hpp"
+#include "position.hpp"
+#include "root_move.hpp"
+#include "search_stack.hpp"
+#include "time_manager.hpp"
+#include "transposition_table.hpp"
+
+struct SearchParameters {
+    int max_depth = -1;
+
+    int max_time_ms = -1;
+
+    int wtime_ms  = -1;
+    int btime_ms  = -1;
+    int winc_ms   = -1;
+    int binc_ms   = -1;
+    int movestogo = -1;
+};
+
+// set through the engine between searches, every worker reads the same ones
+struct SearchOptions {
+    size_t multi_pv{1};
+    bool   qsearch_checks{};
+};
+
+// one thread of the search with everything it writes to: the position copy, the histories, the frames and the root
+// moves. the transposition table, the options and the stop flag are shared between all workers
+class SearchWorker {
+   public:
+    using Workers = std::vector<std::unique_ptr<SearchWorker>>;
+
+    SearchWorker(size_t id, const Workers& workers, TranspositionTable& tt, const SearchOptions& options,
+                 TimeManager& time, std::atomic<bool>& stop)
+        : m_id(id), m_workers(workers), m_tt(tt), m_options(options), m_time(time), m_stop(stop) {
+        m_root_moves.reserve(SearchFrame::MAX_MOVES);
+    }
+
+    // a new game, nothing learned so far applies
+    void clear() {
+        m_stack.clearKillers();
+        m_quiet_history.clear();
+        m_capture_history.clear();
+        m_continuation_history.clear();
+        m_counter_moves.clear();
+    }
+
+    // the tree moved on by at least a ply, the killers are stale while the histories still mostly apply
+    void newSearch() {
+        m_stack.clearKillers();
+        m_quiet_history.age(1, 2);
+        m_capture_history.age(1, 2);
+        m_continuation_history.age(1, 2);
+    }
+
+    void resetCounters() {
+        m_counters.nodes.store(0, std::memory_order_relaxed);
+        m_counters.qnodes.store(0, std::memory_order_relaxed);
+        m_pawn_table.resetCounters();
+    }
+
+    // iterative deepening on a private copy of the position. only the main worker keeps the time and reports, the
+    // helpers search the same tree and pass on what they find through the shared transposition table
+    void search(Position position, std::span<const Key> game_keys, const SearchParameters& parameters) {
+        m_game_keys       = game_keys;
+        m_seldepth        = 0;
+        m_last_info_ms    = 0;
+        m_completed_depth = 0;
+        m_next_time_check = isMain() ? MIN_TIME_CHECK_NODES : std::numeric_limits<uint64_t>::max();
+
+        // the first frame is only borrowed for generation, the root moves live in their own list
+        SearchFrame::MoveList& moves = m_stack[0].moves;
+        const size_t           size  = position.generateMoves<GenerationTypes::LEGAL>(moves.data());
+
+        m_root_moves.clear();
+        if (size == 0) return;
+
+        for (size_t i = 0; i < size; ++i) m_root_moves.push_back(RootMove{.move = moves[i]});
+
+        const Move tt_move = m_tt.probe(position.key()).move();
+        auto       tt_root = std::ranges::find(m_root_moves, tt_move, &RootMove::move);
+        if (tt_root != m_root_moves.end()) std::iter_swap(m_root_moves.begin(), tt_root);
+
+        m_best_line = RootMove{.move = m_root_moves[0].move};
+
+        const size_t lines = std::min(m_options.multi_pv, size);
+
+        // every ply of the deepest line needs its frame, and the depth has to fit the transposition table
+        const int max_depth = std::min(parameters.max_depth != -1 ? parameters.max_depth : 64, MAX_PLY - 1);
+
+        for (int depth = 1; depth <= max_depth; ++depth) {
+            if (m_stop) break;
+            if (!isMain() && skipsDepth(depth)) continue;
+
+            m_current_depth = depth;
+            if (depth > 1) {
+                m_quiet_history.age(3, 4);
+                m_capture_history.age(3, 4);
+            }
+            for (RootMove& root_move : m_root_moves) {
+                root_move.previous_score = root_move.score;
+                root_move.nodes          = 0;
+            }
+
+            // every line is searched without the moves of the lines above it
+            for (size_t pv_index = 0; pv_index < lines && !m_stop; ++pv_index) {
+                const int previous_score = m_root_moves[pv_index].previous_score;
+
+                // aspiration window around the last score, widened on whichever side the search falls out of
+                int delta = ASPIRATION_DELTA;
+                int alpha = -Evaluation::MATE_SCORE;
+                int beta  = Evaluation::MATE_SCORE;
+                if (depth >= ASPIRATION_MIN_DEPTH && std::abs(previous_score) < Evaluation::MATE_THRESHOLD) {
+                    alpha = std::max(previous_score - delta, -Evaluation::MATE_SCORE);
+                    beta  = std::min(previous_score + delta, Evaluation::MATE_SCORE);
+                }
+
+                while (true) {
+                    const int score = searchRoot(position, pv_index, depth, alpha, beta);
+
+                    if (m_stop) break;
+
+                    if (score <= alpha && alpha > -Evaluation::MATE_SCORE) {
+                        alpha = std::max(score - delta, -Evaluation::MATE_SCORE);
+                    } else if (score >= beta && beta < Evaluation::MATE_SCORE) {
+                        beta = std::min(score + delta, Evaluation::MATE_SCORE);
+                    } else {
+                        break;
+                    }
+                    delta *= 2;
+                }
+
+                sortRootMoves(pv_index + 1);
+            }
+
+            if (!m_stop) {
+                m_completed_depth = depth;
+                m_best_line       = m_root_moves[0];
+
+                m_tt.store(position.key(), bestMove(), scoreToTT(bestScore(), 0), depth, Bound::EXACT);
+                if (isMain()) {
+                    printIteration(depth, lines);
+                    scheduleTimeCheck(m_last_info_ms);
+
+                    uint64_t iteration_nodes = 0;
+                    for (const RootMove& root_move : m_root_moves) iteration_nodes += root_move.nodes;
+                    if (m_time.optimumReached(elapsedMs(), bestMove(), bestScore(), m_root_moves[0].nodes,
+                                              iteration_nodes))
+                        m_stop = true;
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] bool     isMain() const { return m_id == 0; }
+    [[nodiscard]] uint64_t nodes() const { return m_counters.nodes.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t qnodes() const { return m_counters.qnodes.load(std::memory_order_relaxed); }
+
+    // empty after a search from a position without legal moves
+    [[nodiscard]] const std::vector<RootMove>& rootMoves() const { return m_root_moves; }
+
+    // the result of the last completed iteration
+    [[nodiscard]] Move bestMove() const { return m_best_line.move; }
+    [[nodiscard]] int  bestScore() const { return m_best_line.score; }
+    [[nodiscard]] int  completedDepth() const { return m_completed_depth; }
+    [[nodiscard]] int  currentDepth() const { return m_current_depth; }
+
+    // reported once the search is over when the vote picks this worker's move, so the last line the gui saw is the
+    // one that is played
+    void printBestLine() const { printLine(m_best_line, m_completed_depth, 1, elapsedMs(), m_tt.hashfull()); }
+
+   private:
+    static constexpr int MAX_PLY = SearchStack::MAX_PLY;
+
+    // principal variation search over the root moves from pv_index on, only the first one gets the full window
+    int searchRoot(Position& position, size_t pv_index, int depth, int alpha, int beta) {
+        int    best_score = -Evaluation::MATE_SCORE;
+        size_t best_index = pv_index;  // a fail low has no best move, the order stays as it is
+
+        for (size_t i = pv_index; i < m_root_moves.size(); ++i) m_root_moves[i].score = -Evaluation::MATE_SCORE;
+        m_stack[0].key = position.key();
+
+        for (size_t i = pv_index; i < m_root_moves.size(); i++) {
+            RootMove&      root_move    = m_root_moves[i];
+            const Move     move         = root_move.move;
+            const uint64_t nodes_before = nodes();
+
+            recordMove(position, 0, move);
+            auto undo = position.makeMove(move);
+
+            int score = 0;
+            if (i == pv_index) {
+                score = -minimax(position, depth - 1, -beta, -alpha, 1);
+            } else {
+                score = -minimax(position, depth - 1, -alpha - 1, -alpha, 1);
+                if (score > alpha && score < beta) score = -minimax(position, depth - 1, -beta, -alpha, 1);
+            }
+
+            position.unmakeMove(move, undo);
+            root_move.nodes += nodes() - nodes_before;
+
+            if (m_stop) break;
+
+            if (i == pv_index || score > alpha) {
+                const SearchFrame& child = m_stack[1];
+
+                root_move.score     = score;
+                root_move.pv[0]     = move;
+                root_move.pv_length = child.pv_length + 1;
+                std::copy_n(child.pv.begin(), child.pv_length, root_move.pv.begin() + 1);
+            }
+
+            if (score > best_score) {
+                best_score = score;
+                if (score > alpha) {
+                    alpha      = score;
+                    best_index = i;
+                    if (alpha >= beta) break;
+                }
+            }
+        }
+
+        pullToFront(pv_index, best_index);
+        return best_score;
+    }
+
+    int minimax(Position& position, int depth, int alpha, int beta, int ply, bool allow_null = true) {
+        if (depth <= 0) return qsearch(position, alpha, beta, ply, 0);
+
+        if (countNode() >= m_next_time_check) checkTime();
+        if (m_stop) return 0;
+
+        // the depth clamp keeps lines inside the stack, this only protects the last frame
+        if (ply >= MAX_PLY - 1) return Evaluation::evaluate(position, m_pawn_table, m_material_table);
+
+        SearchFrame& frame = m_stack[ply];
+        frame.pv_length    = 0;
+        m_seldepth         = std::max(m_seldepth, ply);
+
+        if (isDraw(position, ply)) return 0;
+        frame.key = position.key();
+
+        // the node type and the bound stored for it come from the window the node was called with
+        const bool pv_node        = beta - alpha > 1;
+        const int  alpha_original = alpha;
+
+        // a draw the side to move can force is a lower bound, often enough for a cutoff without generating a move
+        if (alpha < 0 && upcomingRepetition(position, ply)) {
+            alpha = 0;
+            if (alpha >= beta) return alpha;
+        }
+
+        const bool    in_check = position.isCheck();
+        const TTEntry tt_entry = m_tt.probe(position.key());
+        const Move    tt_move  = tt_entry.move();
+
+        // pv nodes are always searched, a cutoff there would cut the principal variation short
+        if (!pv_node && tt_entry.occupied() && tt_entry.depth() >= depth) {
+            const int tt_score = scoreFromTT(tt_entry.score(), ply);
+            if (tt_entry.bound() == Bound::EXACT || (tt_entry.bound() == Bound::LOWER && tt_score >= beta) ||
+                (tt_entry.bound() == Bound::UPPER && tt_score <= alpha))
+                return tt_score;
+        }
+
+        // null move: if passing still fails high, a real move would too. not trusted without pieces (zugzwang)
+        if (!pv_node && allow_null && !in_check && depth >= NULL_MOVE_MIN_DEPTH &&
+            position.hasNonPawnMaterial(position.us())) {
+            const int static_eval = Evaluation::evaluate(position, m_pawn_table, m_material_table);
+            frame.static_eval     = static_eval;
+
+            if (static_eval >= beta) {
+                const int reduction = 3 + depth / 4 + std::min((static_eval - beta) / 200, 3);
+
+                recordNullMove(ply);
+                auto undo  = position.makeNullMove();
+                int  score = -minimax(position, depth - reduction - 1, -beta, -beta + 1, ply + 1, false);
+                position.unmakeNullMove(undo);
+
+                if (m_stop) return 0;
+
+                if (score >= beta) {
+                    // a mate found after passing is not a proven one
+                    if (score >= Evaluation::MATE_THRESHOLD) score = beta;
+
+                    if (depth < NULL_MOVE_VERIFICATION_DEPTH) return score;
+
+                    // deep cutoffs are verified by a reduced search without null moves
+                    if (minimax(position, depth - reduction, beta - 1, beta, ply, false) >= beta) return score;
+                    if (m_stop) return 0;
+                }
+            }
+        }
+
+        const Killers killers = frame.killers;
+
+        const SearchFrame& previous     = m_stack[ply - 1];
+        const Move         counter_move = previous.piece.hasValue()
+                                              ? m_counter_moves.get(previous.piece, previous.move.to())
+                                              : Move{};
+
+        MovePicker picker(position, frame, tt_move, counter_move, m_quiet_history, m_capture_history,
+                          {previous.continuation, m_stack[ply - 2].continuation});
+
+        size_t move_count = 0;
+
+        // moves that were searched without causing the cutoff, they are penalized once one happens
+        size_t quiet_count   = 0;
+        size_t capture_count = 0;
+
+        int  best_score = -Evaluation::MATE_SCORE;
+        Move best_move  = Move{};
+
+        for (Move move = picker.next(); move.hasValue(); move = picker.next()) {
+            const size_t i     = move_count++;
+            const bool   quiet = !position.isCapture(move) && !move.isPromotion();
+
+            // a quiet move that hangs more than the depth can make up for is not searched. never the last hope of a
+            // node that has nothing better than being mated
+            if (!pv_node && !in_check && quiet && i > 0 && depth <= SEE_QUIET_MAX_DEPTH &&
+                best_score > -Evaluation::MATE_THRESHOLD && !position.see(move, -SEE_QUIET_MARGIN * depth * depth))
+                continue;
+
+            recordMove(position, ply, move);
+            auto undo = position.makeMove(move);
+
+            // later moves only have to be proven worse than the first, a fail high is re-searched with the full window
+            int score = 0;
+            if (i == 0) {
+                score = -minimax(position, depth - 1, -beta, -alpha, ply + 1);
+            } else {
+                // late quiet moves are searched shallower first and only get the full depth if they beat alpha
+                int reduction = 0;
+                if (depth >= LMR_MIN_DEPTH && i >= LMR_MIN_MOVES && quiet && !in_check) {
+                    reduction = REDUCTIONS[static_cast<size_t>(std::min(depth, 63))][std::min<size_t>(i, 63)];
+                    if (pv_node) reduction--;
+                    if (position.isCheck()) reduction--;
+                    if (move == killers[0] || move == killers[1]) reduction--;
+                    reduction = std::clamp(reduction, 0, depth - 2);
+                }
+
+                score = -minimax(position, depth - 1 - reduction, -alpha - 1, -alpha, ply + 1);
+                if (reduction > 0 && score > alpha) score = -minimax(position, depth - 1, -alpha - 1, -alpha, ply + 1);
+                if (score > alpha && score < beta) score = -minimax(position, depth - 1, -beta, -alpha, ply + 1);
+            }
+
+            position.unmakeMove(move, undo);
+
+            if (m_stop) return 0;
+
+            if (score > best_score) {
+                best_score = score;
+                best_move  = move;
+                if (score > alpha) {
+                    alpha = score;
+                    if (pv_node) updatePv(ply, move);
+                    if (alpha >= beta) break;
+                }
+            }
+
+            if (quiet && quiet_count < frame.quiets_tried.size())
+                frame.quiets_tried[quiet_count++] = move;
+            else if (!quiet && position.isCapture(move) && capture_count < frame.captures_tried.size())
+                frame.captures_tried[capture_count++] = move;
+        }
+
+        if (best_score >= beta) {
+            updateHistories(position, best_move, depth, ply, std::span(frame.quiets_tried.data(), quiet_count),
+                            std::span(frame.captures_tried.data(), capture_count));
+        }
+
+        if (move_count == 0) {
+            if (in_check) return -Evaluation::MATE_SCORE + ply;
+            return 0;
+        }
+
+        Bound bound = Bound::EXACT;
+        if (best_score >= beta)
+            bound = Bound::LOWER;
+        else if (best_score <= alpha_original)
+            bound = Bound::UPPER;
+
+        m_tt.store(position.key(), bound == Bound::UPPER ? Move{} : best_move, scoreToTT(best_score, ply), depth,
+                   bound);
+
+        return best_score;
+    }
+
+    // resolves captures and promotions past the horizon, so the static eval is only trusted in quiet positions
+    int qsearch(Position& position, int alpha, int beta, int ply, int qply) {
+        if (countNode() >= m_next_time_check) checkTime();
+        if (m_stop) return 0;
+        countQNode();
+
+        // the pv ends where the quiescence search starts
+        m_stack[ply].pv_length = 0;
+        m_seldepth             = std::max(m_seldepth, ply);
+
+        // the line can't outgrow the stack, in practice the captures run out long before
+        if (ply >= MAX_PLY - 1) return Evaluation::evaluate(position, m_pawn_table, m_material_table);
+
+        const bool in_check = position.isCheck();
+
+        // standing pat is not an option in check, every evasion is searched instead
+        int stand_pat  = 0;
+        int best_score = -Evaluation::MATE_SCORE + ply;
+        if (!in_check) {
+            stand_pat = Evaluation::evaluate(position, m_pawn_table, m_material_table);
+            if (stand_pat >= beta) return stand_pat;
+
+            best_score = stand_pat;
+            alpha      = std::max(alpha, stand_pat);
+        }
+
+        SearchFrame::MoveList&  moves  = m_stack[ply].moves;
+        SearchFrame::ScoreList& scores = m_stack[ply].scores;
+
+        size_t size = 0;
+        if (in_check) {
+            size = position.generateMoves<GenerationTypes::LEGAL>(moves.data());
+            if (size == 0) return -Evaluation::MATE_SCORE + ply;
+        } else {
+            size = position.generateMoves<GenerationTypes::CAPTURES>(moves.data());
+            if (qply == 0 && m_options.qsearch_checks)
+                size += generateQuietChecks(position, m_stack[ply + 1].moves, moves.data() + size);
+        }
+        for (size_t i = 0; i < size; ++i) scores[i] = MovePicker::mvvLva(position, moves[i]);
+
+        for (size_t i = 0; i < size; ++i) {
+            // selection instead of a full sort, most nodes cut off on one of the first captures
+            size_t best = i;
+            for (size_t j = i + 1; j < size; ++j) {
+                if (scores[j] > scores[best]) best = j;
+            }
+            std::swap(moves[i], moves[best]);
+            std::swap(scores[i], scores[best]);
+
+            const Move move = moves[i];
+
+            // delta pruning: even winning the captured piece for free can't bring the score back to alpha
+            if (!in_check && !move.isPromotion() && position.isCapture(move) &&
+                stand_pat + Evaluation::pieceValue(MovePicker::capturedType(position, move)) + DELTA_MARGIN <= alpha)
+                continue;
+
+            // nor does a capture that loses material once the recaptures are played out
+            if (!in_check && !position.see(move, 0)) continue;
+
+            auto undo  = position.makeMove(move);
+            int  score = -qsearch(position, -beta, -alpha, ply + 1, qply + 1);
+            position.unmakeMove(move, undo);
+
+            if (m_stop) return 0;
+
+            if (score > best_score) {
+                best_score = score;
+                if (score > alpha) {
+                    alpha = score;
+                    if (alpha >= beta) break;
+                }
+            }
+        }
+
+        return best_score;
+    }
+
+    // called by the main worker once its nodes reach the budget of the last check
+    void checkTime() {
+        if (!isMain()) return;
+
+        const int64_t elapsed = elapsedMs();
+        scheduleTimeCheck(elapsed);
+
+        if (m_time.maximumReached(elapsed)) {
+            m_stop = true;
+        }
+
+        // deep iterations can take minutes, the gui still wants to see the search move in between
+        if (elapsed - m_last_info_ms >= INFO_INTERVAL_MS) {
+            m_last_info_ms = elapsed;
+            std::cout << "info depth " << m_current_depth << " seldepth " << m_seldepth << " nodes " << totalNodes()
+                      << " nps " << nps(elapsed) << " time " << elapsed << " hashfull " << m_tt.hashfull()
+                      << std::endl;
+        }
+    }
+
+    // the piece is read off the board before the move is made
+    void recordMove(const Position& position, int ply, Move move) {
+        SearchFrame& frame = m_stack[ply];
+
+        frame.move         = move;
+        frame.piece        = position.at(move.from());
+        frame.continuation = &m_continuation_history.row(frame.piece, move.to());
+    }
+    void recordNullMove(int ply) {
+        SearchFrame& frame = m_stack[ply];
+
+        frame.move         = Move{};
+        frame.piece        = Pieces::NONE;
+        frame.continuation = nullptr;
+    }
+
+    // rewards the move that cut off and punishes the ones of the same kind tried before it
+    void updateHistories(const Position& position, Move best_move, int depth, int ply, std::span<const Move> quiets,
+                         std::span<const Move> captures) {
+        const int bonus = HistoryTables::bonus(depth);
+
+        if (!position.isCapture(best_move) && !best_move.isPromotion()) {
+            Killers& killers = m_stack[ply].killers;
+            if (killers[0] != best_move) {
+                killers[1] = killers[0];
+                killers[0] = best_move;
+            }
+
+            const SearchFrame& previous = m_stack[ply - 1];
+            if (previous.piece.hasValue()) m_counter_moves.set(previous.piece, previous.move.to(), best_move);
+
+            updateQuietHistories(position, ply, best_move, bonus);
+            for (const Move move : quiets) updateQuietHistories(position, ply, move, -bonus);
+        } else if (position.isCapture(best_move)) {
+            m_capture_history.update(position.at(best_move.from()), best_move.to(),
+                                     MovePicker::capturedType(position, best_move), bonus);
+        }
+
+        for (const Move move : captures) {
+            m_capture_history.update(position.at(move.from()), move.to(), MovePicker::capturedType(position, move),
+                                     -bonus);
+        }
+    }
+
+    // the child has just returned its own line, which becomes the tail of this one
+    void updatePv(int ply, Move move) {
+        SearchFrame&       frame = m_stack[ply];
+        const SearchFrame& child = m_stack[ply + 1];
+
+        frame.pv[0] = move;
+        std::copy_n(child.pv.begin(), child.pv_length, frame.pv.begin() + 1);
+        frame.pv_length = child.pv_length + 1;
+    }
+
+    // one line per principal variation, best first
+    void printIteration(int depth, size_t lines) {
+        const int64_t elapsed  = elapsedMs();
+        const int     hashfull = m_tt.hashfull();
+        m_last_info_ms         = elapsed;
+
+        for (size_t line = 0; line < lines; ++line) printLine(m_root_moves[line], depth, line + 1, elapsed, hashfull);
+    }
+
+    void printLine(const RootMove& root_move, int depth, size_t multipv, int64_t elapsed, int hashfull) const {
+        const int score = root_move.score;
+
+        std::cout << "info depth " << depth << " seldepth " << m_seldepth << " multipv " << multipv << " score ";
+        if (score >= Evaluation::MATE_THRESHOLD)
+            std::cout << "mate " << (Evaluation::MATE_SCORE - score + 1) / 2;
+        else if (score <= -Evaluation::MATE_THRESHOLD)
+            std::cout << "mate " << -(Evaluation::MATE_SCORE + score) / 2;
+        else
+            std::cout << "cp " << score;
+        std::cout << " nodes " << totalNodes() << " nps " << nps(elapsed) << " time " << elapsed << " hashfull "
+                  << hashfull << " pv";
+
+        for (size_t i = 0; i < root_move.pv_length; ++i) std::cout << ' ' << root_move.pv[i].toString();
+        std::cout << std::endl;
+    }
+
+    // ranks the lines found so far. insertion sort, stable and without the buffer std::stable_sort would allocate
+    void sortRootMoves(size_t lines) {
+        for (size_t i = 1; i < lines; ++i) {
+            for (size_t j = i; j > 0 && m_root_moves[j].score > m_root_moves[j - 1].score; --j)
+                std::swap(m_root_moves[j], m_root_moves[j - 1]);
+        }
+    }
+
+    // the rest keeps its relative order, the trees below the root are tuned to it by the earlier iterations
+    void pullToFront(size_t first, size_t index) {
+        for (size_t i = index; i > first; --i) std::swap(m_root_moves[i], m_root_moves[i - 1]);
+    }
+
+    // fifty moves without a capture or a pawn move, or a position that occurred before. a single repetition is
+    // scored as a draw already, a side that could avoid the third one would have avoided the second. nothing before
+    // the last irreversible move can come back, the scan stops there
+    [[nodiscard]] bool isDraw(Position& position, int ply) {
+        const int halfmove = position.halfmove().value();
+
+        // a mate on the hundredth halfmove still counts. the node's own frame is free for the evasions at this point
+        if (halfmove >= 100)
+            return !position.isCheck() || position.generateMoves<GenerationTypes::LEGAL>(m_stack[ply].moves.data()) > 0;
+
+        const Key key = position.key();
+        for (int distance = 4; distance <= halfmove; distance += 2) {
+            const int back = ply - distance;
+            if (back >= 0) {
+                if (m_stack[back].key == key) return true;
+                continue;
+            }
+
+            // before the root, in the game. its last key is the position one ply above the root
+            const auto index = static_cast<std::ptrdiff_t>(m_game_keys.size()) + back;
+            if (index < 0) break;
+            if (m_game_keys[static_cast<size_t>(index)] == key) return true;
+        }
+        return false;
+    }
+
+    // one reversible move of the side to move leads back to a position of the line. only the plies after the root
+    // count, a position from before it was left on purpose and coming back to it once is not yet a draw
+    [[nodiscard]] bool upcomingRepetition(const Position& position, int ply) const {
+        const int end = std::min<int>(position.halfmove().value(), ply - 1);
+        const Key key = position.key();
+
+        for (int distance = 3; distance <= end; distance += 2) {
+            const Move move = Cuckoo::find(key ^ m_stack[ply - distance].key);
+            if (move.hasValue() && !(Bitboard::between(move.from(), move.to()) & position.occupancyAll()).any())
+                return true;
+        }
+        return false;
+    }
+
+    // reading the clock costs more than a node. the next read is a node count away, as many as the speed measured
+    // so far gets through in TIME_CHECK_MS, and fewer when the maximum is closer than that
+    void scheduleTimeCheck(int64_t elapsed_ms) {
+        const int64_t  ms       = std::clamp<int64_t>(m_time.untilMaximum(elapsed_ms), 1, TIME_CHECK_MS);
+        const uint64_t searched = nodes();
+        const uint64_t per_ms   = searched / static_cast<uint64_t>(std::max<int64_t>(elapsed_ms, 1));
+        const uint64_t budget   = per_ms * static_cast<uint64_t>(ms);
+
+        m_next_time_check = searched + std::clamp(budget, MIN_TIME_CHECK_NODES, MAX_TIME_CHECK_NODES);
+    }
+
+    [[nodiscard]] int64_t elapsedMs() const { return m_time.elapsed(); }
+    [[nodiscard]] uint64_t nps(int64_t elapsed_ms) const {
+        return totalNodes() * 1000 / static_cast<uint64_t>(std::max<int64_t>(elapsed_ms, 1));
+    }
+
+    void updateQuietHistories(const Position& position, int ply, Move move, int bonus) {
+        const Piece piece = position.at(move.from());
+
+        m_quiet_history.update(position.us(), move, bonus);
+        for (const int back : {1, 2}) {
+            if (PieceToHistory* continuation = m_stack[ply - back].continuation)
+                ContinuationHistory::update(*continuation, piece, move.to(), bonus);
+        }
+    }
+
+    static constexpr int64_t INFO_INTERVAL_MS = 1000;
+
+    static constexpr int64_t  TIME_CHECK_MS        = 5;
+    static constexpr uint64_t MIN_TIME_CHECK_NODES = 1024;
+    static constexpr uint64_t MAX_TIME_CHECK_NODES = 1 << 18;
+
+    static constexpr int DELTA_MARGIN         = 200;
+    static constexpr int ASPIRATION_DELTA     = 25;
+    static constexpr int ASPIRATION_MIN_DEPTH = 4;
+
+    static constexpr int NULL_MOVE_MIN_DEPTH          = 3;
+    static constexpr int NULL_MOVE_VERIFICATION_DEPTH = 10;
+
+    static constexpr int SEE_QUIET_MAX_DEPTH = 6;
+    static constexpr int SEE_QUIET_MARGIN    = 40;  // times the depth squared
+
+    static constexpr int    LMR_MIN_DEPTH = 3;
+    static constexpr size_t LMR_MIN_MOVES = 3;
+
+    // late move reductions by [depth][move index], growing with the log of both
+    inline static const std::array<std::array<int, 64>, 64> REDUCTIONS = []() {
+        std::array<std::array<int, 64>, 64> table{};
+        for (size_t depth = 1; depth < 64; ++depth) {
+            for (size_t index = 1; index < 64; ++index) {
+                table[depth][index] = static_cast<int>(
+                    0.75 + std::log(static_cast<double>(depth)) * std::log(static_cast<double>(index)) / 2.25);
+            }
+        }
+        return table;
+    }();
+
+    // the generator has no check detection, so quiet moves are made once to see whether they give check. the child
+    // frame's list is free as scratch space until the first move is made
+    static size_t generateQuietChecks(Position& position, SearchFrame::MoveList& quiets, Move* move_list) {
+        const size_t size  = position.generateMoves<GenerationTypes::LEGAL>(quiets.data());
+        size_t       count = 0;
+
+        for (size_t i = 0; i < size; ++i) {
+            const Move move = quiets[i];
+            if (position.isCapture(move) || move.isPromotion()) continue;
+
+            auto undo = position.makeMove(move);
+            if (position.isCheck()) move_list[count++] = move;
+            position.unmakeMove(move, undo);
+        }
+        return count;
+    }
+
+    // mate scores are stored relative to the node, not to the root, so they stay valid across transpositions
+    static int scoreToTT(int score, int ply) {
+        if (score >= Evaluation::MATE_THRESHOLD) return score + ply;
+        if (score <= -Evaluation::MATE_THRESHOLD) return score - ply;
+        return score;
+    }
+    static int scoreFromTT(int score, int ply) {
+        if (score >= Evaluation::MATE_THRESHOLD) return score - ply;
+        if (score <= -Evaluation::MATE_THRESHOLD) return score + ply;
+        return score;
+    }
+
+    // written by the owning thread only and summed up by the main one. a cache line of its own, so counting nodes
+    // never invalidates the line another thread reads its tables from
+    struct alignas(64) NodeCounters {
+        std::atomic<uint64_t> nodes{};
+        std::atomic<uint64_t> qnodes{};
+    };
+
+    // a single writer needs no locked add, a relaxed load and store is enough. returns the count before this node
+    uint64_t countNode() {
+        const uint64_t count = m_counters.nodes.load(std::memory_order_relaxed);
+        m_counters.nodes.store(count + 1, std::memory_order_relaxed);
+        return count;
+    }
+    void countQNode() { m_counters.qnodes.store(qnodes() + 1, std::memory_order_relaxed); }
+
+    [[nodiscard]] uint64_t totalNodes() const {
+        uint64_t total = 0;
+        for (const auto& worker : m_workers) total += worker->nodes();
+        return total;
+    }
+
+    // helpers leave out every other block of depths, each with its own block size and phase, so the threads spread
+    // over neighbouring depths instead of all racing through the same one
+    static constexpr std::array<int, 20> SKIP_SIZE  = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+    static constexpr std::array<int, 20> SKIP_PHASE = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+    [[nodiscard]] bool skipsDepth(int depth) const {
+        const size_t i = (m_id - 1) % SKIP_SIZE.size();
+        return (depth + SKIP_PHASE[i]) / SKIP_SIZE[i] % 2 != 0;
+    }
+
+    size_t               m_id;
+    const Workers&       m_workers;
+    TranspositionTable&  m_tt;
+    const SearchOptions& m_options;
+    TimeManager&         m_time;  // read and updated by the main worker only
+    std::atomic<bool>&   m_stop;
+
+    std::span<const Key> m_game_keys{};  // the game up to the root, owned by the engine
+
+    ButterflyHistory    m_quiet_history{};
+    CaptureHistory      m_capture_history{};
+    ContinuationHistory m_continuation_history{};
+    CounterMoves        m_counter_moves{};
+
+    PawnTable     m_pawn_table{};
+    MaterialTable m_material_table{};
+
+    SearchStack           m_stack{};
+    std::vector<RootMove> m_root_moves{};
+
+    NodeCounters m_counters{};
+
+    RootMove m_best_line{};  // root_moves[0] as the last completed iteration left it
+    int      m_completed_depth{};
+    int      m_current_depth{};
+    int      m_seldepth{};
+
+    int64_t  m_last_info_ms{};
+    uint64_t m_next_time_check{};  // the node count of the main worker at which the clock is read again
+};
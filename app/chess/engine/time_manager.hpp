@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+#include "evaluation.hpp"
+#include "move.hpp"
+
+// the time one search may take. the optimum is where the search stops between iterations, stretched or shrunk by
+// how settled the result looks, the maximum is where it is cut off wherever it is
+class TimeManager {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int DEFAULT_MOVE_OVERHEAD_MS = 10;
+    static constexpr int MAX_MOVE_OVERHEAD_MS     = 5000;
+
+    // -1 for whatever the go command left out. a movetime is spent whole but for the overhead, without a clock
+    // nothing is limited
+    void init(Clock::time_point start, int time_left_ms, int increment_ms, int moves_to_go, int move_time_ms,
+              int move_overhead_ms) {
+        m_start             = start;
+        m_optimum_ms        = -1;
+        m_maximum_ms        = -1;
+        m_adaptive          = false;
+        m_previous_best     = Move{};
+        m_previous_score    = NO_SCORE;
+        m_stable_iterations = 0;
+
+        if (move_time_ms != -1) {
+            m_optimum_ms = m_maximum_ms = std::max(move_time_ms - move_overhead_ms, 1);
+            return;
+        }
+        if (time_left_ms == -1) return;
+
+        // the overhead is paid on every move, the clock has to cover it for all the moves to come
+        const int64_t moves     = moves_to_go > 0 ? std::min(moves_to_go, MOVES_HORIZON) : MOVES_HORIZON;
+        const int64_t increment = std::max(increment_ms, 0);
+        const int64_t remaining = std::max<int64_t>(time_left_ms - move_overhead_ms, 1);
+
+        m_maximum_ms = std::max<int64_t>(remaining * MAX_SHARE_PERCENT / 100, 1);
+        m_optimum_ms = std::min(remaining / moves + increment * 3 / 4, m_maximum_ms);
+        m_maximum_ms = std::min(m_maximum_ms, m_optimum_ms * MAX_OVER_OPTIMUM);
+        m_adaptive   = true;
+    }
+
+    [[nodiscard]] int64_t elapsed() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_start).count();
+    }
+
+    // the time left before the search is cut off, unbounded without a maximum
+    [[nodiscard]] int64_t untilMaximum(int64_t elapsed_ms) const {
+        return m_maximum_ms == -1 ? std::numeric_limits<int64_t>::max() : m_maximum_ms - elapsed_ms;
+    }
+
+    [[nodiscard]] bool maximumReached(int64_t elapsed_ms) const {
+        return m_maximum_ms != -1 && elapsed_ms >= m_maximum_ms;
+    }
+
+    // called once per completed iteration with its best move and score, and with how many of the iteration's nodes
+    // went into the best move
+    bool optimumReached(int64_t elapsed_ms, Move best_move, int score, uint64_t best_move_nodes, uint64_t nodes) {
+        if (!m_adaptive) return maximumReached(elapsed_ms);
+
+        m_stable_iterations = best_move == m_previous_best ? m_stable_iterations + 1 : 0;
+        const int drop      = m_previous_score == NO_SCORE ? 0 : m_previous_score - score;
+
+        m_previous_best  = best_move;
+        m_previous_score = score;
+
+        // a best move that keeps changing needs more time, one that has held for a few iterations less
+        const double stability = 1.6 - 0.2 * std::min(m_stable_iterations, 5);
+
+        // a falling score means the search has just found a problem, a rising one needs no second look
+        const double falling = std::clamp(1.0 + drop / 200.0, 0.8, 1.5);
+
+        // when nearly all the effort went into the best move, the others were refuted quickly
+        const double effort = nodes == 0 ? 0.5 : static_cast<double>(best_move_nodes) / static_cast<double>(nodes);
+        const double easy   = std::clamp(1.5 - effort, 0.6, 1.4);
+
+        const double soft_ms = static_cast<double>(m_optimum_ms) * stability * falling * easy;
+        return elapsed_ms >= std::min(soft_ms, static_cast<double>(m_maximum_ms));
+    }
+
+   private:
+    static constexpr int NO_SCORE = Evaluation::MATE_SCORE + 1;
+
+    static constexpr int     MOVES_HORIZON     = 40;  // moves the clock is spread over without a movestogo
+    static constexpr int64_t MAX_SHARE_PERCENT = 80;  // of the clock, at most, for one move
+    static constexpr int64_t MAX_OVER_OPTIMUM  = 5;
+
+    Clock::time_point m_start{};
+    int64_t           m_optimum_ms{-1};
+    int64_t           m_maximum_ms{-1};
+    bool              m_adaptive{};
+
+    Move m_previous_best{};
+    int  m_previous_score{NO_SCORE};
+    int  m_stable_iterations{};
+};
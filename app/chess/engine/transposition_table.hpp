@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "move.hpp"
+#include "strong_value.hpp"
+#include "zobrist.hpp"
+
+enum class Bound : uint8_t {
+    NONE,
+    UPPER,
+    LOWER,
+    EXACT
+};
+
+// whole entry is packed into a single word, so it is read and written atomically and never tears between threads
+struct TTEntry : public StrongValue<TTEntry, uint64_t> {
+    using StrongValue::StrongValue;
+
+    constexpr TTEntry(Key key, Move move, int score, int depth, Bound bound, uint8_t age)
+        : StrongValue(key >> KEY_SHIFT | static_cast<uint64_t>(move.value()) << MOVE_SHIFT |
+                      static_cast<uint64_t>(static_cast<uint16_t>(score)) << SCORE_SHIFT |
+                      static_cast<uint64_t>(static_cast<uint8_t>(depth + 1)) << DEPTH_SHIFT |
+                      static_cast<uint64_t>(bound) << BOUND_SHIFT |
+                      static_cast<uint64_t>(age & AGE_MASK) << AGE_SHIFT) {}
+
+    [[nodiscard]] constexpr bool     occupied() const { return ((m_value >> DEPTH_SHIFT) & 0xFF) != 0; }
+    [[nodiscard]] constexpr uint16_t check() const { return static_cast<uint16_t>(m_value); }
+    [[nodiscard]] constexpr bool     matches(Key key) const { return occupied() && check() == (key >> KEY_SHIFT); }
+
+    [[nodiscard]] constexpr Move    move() const { return Move(static_cast<uint16_t>(m_value >> MOVE_SHIFT)); }
+    [[nodiscard]] constexpr int     score() const { return static_cast<int16_t>(m_value >> SCORE_SHIFT); }
+    [[nodiscard]] constexpr int     depth() const { return static_cast<int>((m_value >> DEPTH_SHIFT) & 0xFF) - 1; }
+    [[nodiscard]] constexpr Bound   bound() const { return Bound((m_value >> BOUND_SHIFT) & 0x3); }
+    [[nodiscard]] constexpr uint8_t age() const { return static_cast<uint8_t>((m_value >> AGE_SHIFT) & AGE_MASK); }
+
+    static constexpr uint8_t AGE_MASK = 0x3F;
+
+   private:
+    // the top key bits are kept as a check, the low ones are already implied by the bucket index
+    static constexpr int KEY_SHIFT   = 48;
+    static constexpr int MOVE_SHIFT  = 16;
+    static constexpr int SCORE_SHIFT = 32;
+    static constexpr int DEPTH_SHIFT = 48;
+    static constexpr int BOUND_SHIFT = 56;
+    static constexpr int AGE_SHIFT   = 58;
+};
+
+class TranspositionTable {
+   public:
+    static constexpr size_t DEFAULT_SIZE_MB = 16;
+    static constexpr size_t MAX_SIZE_MB     = 65536;
+
+    explicit TranspositionTable(size_t size_mb = DEFAULT_SIZE_MB) { resize(size_mb); }
+
+    // the bucket count is rounded down to a power of two, so indexing is a single mask
+    void resize(size_t size_mb) {
+        size_mb = std::clamp<size_t>(size_mb, 1, MAX_SIZE_MB);
+
+        const size_t count = std::bit_floor(size_mb * 1024 * 1024 / sizeof(Bucket));
+
+        m_buckets = std::make_unique<Bucket[]>(count);
+        m_mask    = count - 1;
+        m_age     = 0;
+    }
+
+    void clear() {
+        for (size_t i = 0; i <= m_mask; ++i) {
+            for (auto& entry : m_buckets[i].entries) entry.store(0, std::memory_order_relaxed);
+        }
+        m_age = 0;
+    }
+
+    void newSearch() { m_age = static_cast<uint8_t>((m_age + 1) & TTEntry::AGE_MASK); }
+
+    [[nodiscard]] TTEntry probe(Key key) const {
+        const Bucket& bucket = m_buckets[key & m_mask];
+
+        for (const auto& slot : bucket.entries) {
+            const TTEntry entry(slot.load(std::memory_order_relaxed));
+            if (entry.matches(key)) return entry;
+        }
+        return TTEntry{};
+    }
+
+    void store(Key key, Move move, int score, int depth, Bound bound) {
+        Bucket& bucket = m_buckets[key & m_mask];
+
+        std::atomic<uint64_t>* replace = &bucket.entries[0];
+        int                    worst   = INT_MAX;
+
+        for (auto& slot : bucket.entries) {
+            const TTEntry entry(slot.load(std::memory_order_relaxed));
+
+            if (entry.matches(key)) {
+                // keep a deeper result of the current search unless the new one is exact
+                if (bound != Bound::EXACT && entry.age() == m_age && depth + 4 < entry.depth()) return;
+                if (!move.hasValue()) move = entry.move();
+
+                replace = &slot;
+                break;
+            }
+
+            const int relative_age = (m_age - entry.age()) & TTEntry::AGE_MASK;
+            const int value        = entry.occupied() ? entry.depth() - (8 * relative_age) : INT_MIN;
+            if (value < worst) {
+                worst   = value;
+                replace = &slot;
+            }
+        }
+
+        replace->store(TTEntry(key, move, score, depth, bound, m_age).value(), std::memory_order_relaxed);
+    }
+
+    // permille of a fixed sample of entries filled during the current search
+    [[nodiscard]] int hashfull() const {
+        const size_t buckets = std::min<size_t>(1000 / ENTRIES_PER_BUCKET, m_mask + 1);
+
+        size_t used = 0;
+        for (size_t i = 0; i < buckets; ++i) {
+            for (const auto& slot : m_buckets[i].entries) {
+                const TTEntry entry(slot.load(std::memory_order_relaxed));
+                if (entry.occupied() && entry.age() == m_age) used++;
+            }
+        }
+        return static_cast<int>(used * 1000 / (buckets * ENTRIES_PER_BUCKET));
+    }
+
+   private:
+    static constexpr size_t ENTRIES_PER_BUCKET = 8;
+
+    struct alignas(64) Bucket {
+        std::array<std::atomic<uint64_t>, ENTRIES_PER_BUCKET> entries{};
+    };
+    static_assert(sizeof(Bucket) == 64, "Bucket must fill exactly one cache line");
+
+    std::unique_ptr<Bucket[]> m_buckets{};
+    size_t                    m_mask{};
+    uint8_t                   m_age{};
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "move.hpp"
+#include "piece.hpp"
+#include "square.hpp"
+#include "zobrist.hpp"
+
+// every reversible move of a piece on an empty board, keyed by what it changes in the position key. two positions
+// whose keys differ by one of them are a single move apart (Marcel van Kervinck's cuckoo tables)
+namespace Cuckoo {
+inline constexpr size_t SIZE = 8192;
+
+[[nodiscard]] constexpr size_t h1(Key key) { return static_cast<size_t>(key) & (SIZE - 1); }
+[[nodiscard]] constexpr size_t h2(Key key) { return static_cast<size_t>(key >> 16) & (SIZE - 1); }
+
+struct Table {
+    std::array<Key, SIZE>  keys{};
+    std::array<Move, SIZE> moves{};
+};
+
+// whether a piece of this type goes from one square to the other on an empty board, in one move
+[[nodiscard]] constexpr bool reaches(PieceType type, Square from, Square to) {
+    const int files = File::distance(from.file(), to.file());
+    const int ranks = Rank::distance(from.rank(), to.rank());
+
+    const bool diagonal = files == ranks;
+    const bool straight = files == 0 || ranks == 0;
+    if (type == PieceTypes::KNIGHT) return files * ranks == 2;
+    if (type == PieceTypes::BISHOP) return diagonal;
+    if (type == PieceTypes::ROOK) return straight;
+    if (type == PieceTypes::QUEEN) return diagonal || straight;
+    return files <= 1 && ranks <= 1;
+}
+
+// generated at compile time from the zobrist keys. 3668 moves, each in one of its two slots
+inline constexpr Table TABLE = []() constexpr {
+    Table table{};
+
+    for (const Piece piece : Pieces::all()) {
+        if (piece.type() == PieceTypes::PAWN) continue;
+
+        for (uint8_t i = 0; i < Squares::count(); ++i) {
+            for (uint8_t j = i + 1; j < Squares::count(); ++j) {
+                const Square from(i);
+                const Square to(j);
+                if (!reaches(piece.type(), from, to)) continue;
+
+                Key  key  = Zobrist::piece(piece, from) ^ Zobrist::piece(piece, to) ^ Zobrist::side();
+                Move move = Move(from, to);
+
+                // the one in the way moves on to its other slot until an empty one is found
+                size_t slot = h1(key);
+                while (true) {
+                    std::swap(table.keys[slot], key);
+                    std::swap(table.moves[slot], move);
+                    if (!move.hasValue()) break;
+                    slot = slot == h1(key) ? h2(key) : h1(key);
+                }
+            }
+        }
+    }
+    return table;
+}();
+
+// the move that turns one position into another with the given key difference, or no move
+[[nodiscard]] constexpr Move find(Key key) {
+    if (TABLE.keys[h1(key)] == key) return TABLE.moves[h1(key)];
+    if (TABLE.keys[h2(key)] == key) return TABLE.moves[h2(key)];
+    return Move{};
+}
+};  // namespace Cuckoo
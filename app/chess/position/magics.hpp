@@ -8,6 +8,7 @@
 #include "bitboard.hpp"
 #include "direction.hpp"
 #include "piece_type.hpp"
+#include "prng.hpp"
 #include "square.hpp"
 
 class Magics {
@@ -50,28 +51,6 @@ class Magics {
         }
     };
 
-    class Prng {
-        uint64_t s;
-
-        constexpr uint64_t rand64() {
-            s ^= s >> 12, s ^= s << 25, s ^= s >> 27;
-            return s * 2685821657736338717LL;
-        }
-
-       public:
-        explicit constexpr Prng(uint64_t seed) : s(seed) { assert(seed); }
-
-        template <typename T>
-        constexpr T rand() {
-            return T(rand64());
-        }
-
-        template <typename T>
-        constexpr T sparseRand() {
-            return T(rand64() & rand64() & rand64());
-        }
-    };
-
     static constexpr int    MAX_OCCUPANCIES     = 4096;
     static constexpr size_t ROOK_ATTACKS_SIZE   = 102400;
     static constexpr size_t BISHOP_ATTACKS_SIZE = 5248;
@@ -1,5 +1,7 @@
 #include "position.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cctype>
 #include <cstdint>
@@ -18,6 +20,7 @@
 #include "move_flag.hpp"
 #include "piece.hpp"
 #include "piece_type.hpp"
+#include "psqt.hpp"
 #include "rank.hpp"
 #include "square.hpp"
 #include "undo_info.hpp"
@@ -32,10 +35,20 @@ void Position::reset() {
     for (const Square square : Squares::all()) {
         if (at(square).hasValue()) unsetPiece(square);
     }
+
+    // a board that was never set reads as white pawns everywhere, the sums start over instead of taking them back
+    m_psqt         = {};
+    m_pawn_key     = 0;
+    m_material_key = 0;
+
+    m_key = computeKey();
 }
 void Position::fromFen(const std::string& fen) {
     reset();
-
+    parseFen(fen);
+    m_key = computeKey();
+}
+void Position::parseFen(const std::string& fen) {
     std::istringstream      iss(fen);
     std::deque<std::string> tokens;
     std::string             token;
@@ -127,7 +140,7 @@ void Position::fromFen(const std::string& fen) {
     m_halfmove.set(static_cast<uint8_t>(std::stoi(halfmove)));
 }
 
-bool Position::isAttacked(Square square, Color attacker) const {
+bool Position::isAttacked(Square square, Color attacker, Bitboard occupied) const {
     if (attacker == Colors::WHITE) {
         if ((pawnAttacks<Colors::BLACK>(square) & occupancy(Colors::WHITE, PieceTypes::PAWN)).any()) return true;
     } else {
@@ -140,12 +153,157 @@ bool Position::isAttacked(Square square, Color attacker) const {
     const Bitboard bishops = occupancy(attacker, PieceTypes::BISHOP) | queens;
     const Bitboard rooks   = occupancy(attacker, PieceTypes::ROOK) | queens;
 
-    if (bishops.any() && (pseudoAttacks<PieceTypes::BISHOP>(square) & bishops).any()) return true;
+    if (bishops.any() && (pseudoAttacks<PieceTypes::BISHOP>(square, occupied) & bishops).any()) return true;
 
-    if (rooks.any() && (pseudoAttacks<PieceTypes::ROOK>(square) & rooks).any()) return true;
+    if (rooks.any() && (pseudoAttacks<PieceTypes::ROOK>(square, occupied) & rooks).any()) return true;
 
     return false;
 }
+Bitboard Position::attackersTo(Square square, Bitboard occupied) const {
+    const Bitboard queens = occupancy(PieceTypes::QUEEN);
+
+    return (pawnAttacks<Colors::BLACK>(square) & occupancy(Colors::WHITE, PieceTypes::PAWN)) |
+           (pawnAttacks<Colors::WHITE>(square) & occupancy(Colors::BLACK, PieceTypes::PAWN)) |
+           (pseudoAttacks<PieceTypes::KNIGHT>(square) & occupancy(PieceTypes::KNIGHT)) |
+           (pseudoAttacks<PieceTypes::KING>(square) & occupancy(PieceTypes::KING)) |
+           (pseudoAttacks<PieceTypes::BISHOP>(square, occupied) & (occupancy(PieceTypes::BISHOP) | queens)) |
+           (pseudoAttacks<PieceTypes::ROOK>(square, occupied) & (occupancy(PieceTypes::ROOK) | queens));
+}
+bool Position::see(Move move, int threshold) const {
+    // the special moves are rare enough to be taken as even
+    if (move.isPromotion() || move.flag() == MoveFlags::EN_PASSANT || move.flag() == MoveFlags::CASTLING_KING ||
+        move.flag() == MoveFlags::CASTLING_QUEEN)
+        return threshold <= 0;
+
+    const auto value = [](PieceType type) { return Psqt::PIECE_VALUE[type.value()].midgame(); };
+
+    const Square from = move.from();
+    const Square to   = move.to();
+
+    // what is still won once the opponent has taken back, it has to stay at or above zero
+    int swap = (at(to).hasValue() ? value(at(to).type()) : 0) - threshold;
+    if (swap < 0) return false;
+
+    swap = value(at(from).type()) - swap;
+    if (swap <= 0) return true;
+
+    const Bitboard diagonal = occupancy(PieceTypes::BISHOP) | occupancy(PieceTypes::QUEEN);
+    const Bitboard straight = occupancy(PieceTypes::ROOK) | occupancy(PieceTypes::QUEEN);
+
+    Bitboard occupied  = occupancyAll() ^ Bitboard::square(from) ^ Bitboard::square(to);
+    Bitboard attackers = attackersTo(to, occupied);
+    Color    side      = m_stm;
+    int      result    = 1;  // whether the side to move is ahead if the exchange stops here
+
+    while (true) {
+        side = !side;
+        attackers &= occupied;
+
+        const Bitboard ours = attackers & occupancy(side);
+        if (ours.empty()) break;
+
+        PieceType type = PieceTypes::KING;
+        for (const PieceType cheaper :
+             {PieceTypes::PAWN, PieceTypes::KNIGHT, PieceTypes::BISHOP, PieceTypes::ROOK, PieceTypes::QUEEN}) {
+            if ((ours & occupancy(cheaper)).any()) {
+                type = cheaper;
+                break;
+            }
+        }
+
+        result ^= 1;
+
+        // the king can only take when nothing can take it back
+        if (type == PieceTypes::KING) return ((attackers & ~occupancy(side)).any() ? result ^ 1 : result) != 0;
+
+        swap = value(type) - swap;
+        if (swap < result) break;
+
+        occupied ^= Bitboard::square(lsb(ours & occupancy(type)));
+        if (type == PieceTypes::PAWN || type == PieceTypes::BISHOP || type == PieceTypes::QUEEN)
+            attackers |= pseudoAttacks<PieceTypes::BISHOP>(to, occupied) & diagonal;
+        if (type == PieceTypes::ROOK || type == PieceTypes::QUEEN)
+            attackers |= pseudoAttacks<PieceTypes::ROOK>(to, occupied) & straight;
+    }
+    return result != 0;
+}
+bool Position::isLegalMove(Move move) const {
+    if (!move.hasValue()) return false;
+
+    const Square from  = move.from();
+    const Square to    = move.to();
+    const Piece  piece = at(from);
+    if (!piece.hasValue() || piece.color() != m_stm || occupancy(m_stm).test(to)) return false;
+
+    // the rare special moves are simply looked up in what the generator would produce
+    if (move.flag() == MoveFlags::CASTLING_KING || move.flag() == MoveFlags::CASTLING_QUEEN ||
+        move.flag() == MoveFlags::EN_PASSANT) {
+        std::array<Move, 4> special{};
+
+        Move* last = generateCastling(special.data());
+        last       = m_stm == Colors::WHITE ? generateEnPassant<Colors::WHITE, true>(last)
+                                            : generateEnPassant<Colors::BLACK, true>(last);
+        return std::find(special.data(), last, move) != last;
+    }
+
+    const Bitboard occupied = occupancyAll();
+
+    if (piece.type() == PieceTypes::PAWN) {
+        const bool      white          = m_stm == Colors::WHITE;
+        const Direction forward        = white ? Directions::N : Directions::S;
+        const Rank      start_rank     = white ? Ranks::R2 : Ranks::R7;
+        const Rank      promotion_rank = white ? Ranks::R8 : Ranks::R1;
+        const Square    single_push    = from.move(forward);
+
+        if ((to.rank() == promotion_rank) != move.isPromotion()) return false;
+
+        if (move.flag() == MoveFlags::PAWN_DOUBLE_PUSH) {
+            if (from.rank() != start_rank || occupied.test(single_push) || to != single_push.move(forward) ||
+                occupied.test(to))
+                return false;
+        } else if ((white ? pawnAttacks<Colors::WHITE>(from) : pawnAttacks<Colors::BLACK>(from)).test(to)) {
+            if (!occupancy(!m_stm).test(to)) return false;
+        } else if (to != single_push || occupied.test(to)) {
+            return false;
+        }
+    } else {
+        if (move.flag() != MoveFlags::USUAL) return false;
+
+        Bitboard attacks = Bitboards::ZERO;
+        if (piece.type() == PieceTypes::KNIGHT)
+            attacks = pseudoAttacks<PieceTypes::KNIGHT>(from);
+        else if (piece.type() == PieceTypes::BISHOP)
+            attacks = pseudoAttacks<PieceTypes::BISHOP>(from);
+        else if (piece.type() == PieceTypes::ROOK)
+            attacks = pseudoAttacks<PieceTypes::ROOK>(from);
+        else if (piece.type() == PieceTypes::QUEEN)
+            attacks = pseudoAttacks<PieceTypes::QUEEN>(from);
+        else
+            attacks = pseudoAttacks<PieceTypes::KING>(from);
+
+        if (!attacks.test(to)) return false;
+
+        if (piece.type() == PieceTypes::KING) return !isAttacked(to, !m_stm, occupied ^ Bitboard::square(from));
+    }
+
+    // covers both pins and unanswered checks: nothing but the captured piece may attack the king afterwards
+    const Square   king  = lsb(occupancy(m_stm, PieceTypes::KING));
+    const Bitboard after = (occupied ^ Bitboard::square(from)) | Bitboard::square(to);
+    return (attackersTo(king, after) & occupancy(!m_stm) & ~Bitboard::square(to)).empty();
+}
+Key Position::computeKey() const {
+    Key key = 0;
+
+    for (const Square square : Squares::all()) {
+        if (at(square).hasValue()) key ^= Zobrist::piece(at(square), square);
+    }
+
+    key ^= Zobrist::castling(m_castling);
+    key ^= Zobrist::enPassant(m_en_passant);
+    if (m_stm == Colors::BLACK) key ^= Zobrist::side();
+
+    return key;
+}
 std::string Position::toFen() const {
     std::stringstream fen;
 
@@ -201,6 +359,14 @@ void Position::setPiece(Square square, Piece piece) {
     at(piece.color()) |= mask;
     at(piece.type()) |= mask;
     at(square) = piece;
+    m_key ^= Zobrist::piece(piece, square);
+
+    m_psqt[piece.color().value()] += Psqt::score(piece, square);
+    if (piece.type() == PieceTypes::PAWN) m_pawn_key ^= Zobrist::piece(piece, square);
+
+    // the key of the n-th piece of a kind, with the square keys standing in for the counts
+    const uint8_t count = popcount(occupancy(piece.color(), piece.type()));
+    m_material_key ^= Zobrist::piece(piece, Square(static_cast<uint8_t>(count - 1)));
 }
 
 void Position::unsetPiece(Square square) {
@@ -209,6 +375,12 @@ void Position::unsetPiece(Square square) {
     m_color[piece.color().value()] &= ~mask;
     m_piece_type[piece.type().value()] &= ~mask;
     m_board[square.value()] = Pieces::NONE;
+    m_key ^= Zobrist::piece(piece, square);
+
+    m_psqt[piece.color().value()] -= Psqt::score(piece, square);
+    if (piece.type() == PieceTypes::PAWN) m_pawn_key ^= Zobrist::piece(piece, square);
+
+    m_material_key ^= Zobrist::piece(piece, Square(popcount(occupancy(piece.color(), piece.type()))));
 }
 
 void Position::movePiece(Square from, Square to) {
@@ -218,16 +390,28 @@ void Position::movePiece(Square from, Square to) {
     m_piece_type[piece.type().value()] ^= move_mask;
     m_board[from.value()] = Pieces::NONE;
     m_board[to.value()]   = piece;
+    m_key ^= Zobrist::piece(piece, from) ^ Zobrist::piece(piece, to);
+
+    m_psqt[piece.color().value()] += Psqt::score(piece, to) - Psqt::score(piece, from);
+    if (piece.type() == PieceTypes::PAWN) m_pawn_key ^= Zobrist::piece(piece, from) ^ Zobrist::piece(piece, to);
 }
 
 UndoInfo Position::makeMove(const Move move) {
     UndoInfo undo_info = {m_castling, m_en_passant, m_halfmove};
 
+    m_key ^= Zobrist::castling(m_castling) ^ Zobrist::enPassant(m_en_passant);
+
     const Square from = move.from();
     const Square to   = move.to();
 
     const Piece captured = move.flag() == MoveFlags::EN_PASSANT ? Piece(!m_stm, PieceTypes::PAWN) : at(to);
 
+    // captures and pawn moves can't be undone, no position before them can occur again
+    if (captured.hasValue() || at(from).type() == PieceTypes::PAWN)
+        m_halfmove.reset();
+    else
+        ++m_halfmove;
+
     if (captured.hasValue()) {
         Square captured_square = to;
 
@@ -281,6 +465,9 @@ UndoInfo Position::makeMove(const Move move) {
 
     m_stm.flip();
 
+    m_key ^= Zobrist::castling(m_castling) ^ Zobrist::enPassant(m_en_passant) ^ Zobrist::side();
+    assert(m_key == computeKey());
+
     undo_info.setCaptured(captured);
 
     return undo_info;
@@ -316,7 +503,33 @@ void Position::unmakeMove(const Move move, const UndoInfo& undo_info) {
         setPiece(captured_square, undo_info.captured());
     }
 
+    m_key ^= Zobrist::castling(m_castling) ^ Zobrist::enPassant(m_en_passant) ^ Zobrist::side();
+
     m_en_passant = undo_info.enPassant();
     m_castling   = undo_info.castling();
     m_halfmove   = undo_info.halfmove();
+
+    m_key ^= Zobrist::castling(m_castling) ^ Zobrist::enPassant(m_en_passant);
+    assert(m_key == computeKey());
+}
+
+UndoInfo Position::makeNullMove() {
+    UndoInfo undo_info = {m_castling, m_en_passant, m_halfmove};
+
+    m_key ^= Zobrist::enPassant(m_en_passant) ^ Zobrist::side();
+    m_en_passant.clear();
+    m_halfmove.reset();
+    m_stm.flip();
+
+    assert(m_key == computeKey());
+    return undo_info;
+}
+
+void Position::unmakeNullMove(const UndoInfo& undo_info) {
+    m_stm.flip();
+    m_en_passant = undo_info.enPassant();
+    m_halfmove   = undo_info.halfmove();
+    m_key ^= Zobrist::enPassant(m_en_passant) ^ Zobrist::side();
+
+    assert(m_key == computeKey());
 }
\ No newline at end of file
@@ -20,8 +20,10 @@
 #include "move_flag.hpp"
 #include "piece.hpp"
 #include "piece_type.hpp"
+#include "psqt.hpp"
 #include "square.hpp"
 #include "undo_info.hpp"
+#include "zobrist.hpp"
 
 enum class Sides : uint8_t {
     US,
@@ -31,7 +33,9 @@ enum class Sides : uint8_t {
 
 enum class GenerationTypes : uint8_t {
     ALL,
-    LEGAL
+    LEGAL,
+    CAPTURES,  // legal captures and promotions
+    QUIETS     // the rest of the legal moves
 };
 
 using Board = std::array<Piece, Squares::count()>;
@@ -53,8 +57,21 @@ class Position {
     UndoInfo makeMove(Move move);
     void     unmakeMove(Move move, const UndoInfo& undo_info);
 
+    // passes the turn without moving, for null-move pruning. nothing repeats across it, the halfmove clock restarts
+    UndoInfo makeNullMove();
+    void     unmakeNullMove(const UndoInfo& undo_info);
+
     [[nodiscard]] auto us() const { return m_stm; }
     [[nodiscard]] auto castling() const { return m_castling; }
+    [[nodiscard]] auto key() const { return m_key; }
+    [[nodiscard]] auto pawnKey() const { return m_pawn_key; }          // of the pawns alone, zero without any
+    [[nodiscard]] auto materialKey() const { return m_material_key; }  // of how many pieces of each kind are left
+    [[nodiscard]] auto halfmove() const { return m_halfmove; }
+
+    // material and piece-square sum of one color, kept up to date by every piece that is set, unset or moved
+    [[nodiscard]] Score psqt(Color color) const { return m_psqt[color.value()]; }
+
+    [[nodiscard]] Key computeKey() const;
 
     [[nodiscard]] const auto& board() const { return m_board; }
 
@@ -83,41 +100,63 @@ class Position {
         return !isAttacked(king, m_stm);
     }
 
-    [[nodiscard]] bool isAttacked(Square square, Color attacker) const;
+    [[nodiscard]] bool isAttacked(Square square, Color attacker) const {
+        return isAttacked(square, attacker, occupancyAll());
+    }
+    [[nodiscard]] bool     isAttacked(Square square, Color attacker, Bitboard occupied) const;
+    [[nodiscard]] Bitboard attackersTo(Square square, Bitboard occupied) const;
+
+    // static exchange evaluation: whether the captures the move starts on its square win at least the threshold,
+    // both sides taking back with the cheapest piece and free to stop. nothing is moved, the sliders behind a piece
+    // join in once it has left. pins are not looked at
+    [[nodiscard]] bool see(Move move, int threshold) const;
+
+    // for moves that weren't generated here, like hash and killer moves
+    [[nodiscard]] bool isLegalMove(Move move) const;
 
     template <GenerationTypes GT>
     size_t generateMoves(Move* move_list) {
         Move* first = move_list;
         if constexpr (GT == GenerationTypes::ALL) {
-            if (m_stm == Colors::WHITE)
-                move_list = generatePawnMoves<Colors::WHITE>(occupancy(m_stm, PieceTypes::PAWN), move_list);
-            else
-                move_list = generatePawnMoves<Colors::BLACK>(occupancy(m_stm, PieceTypes::PAWN), move_list);
+            const Bitboard target = ~occupancy(m_stm);
+
+            if (m_stm == Colors::WHITE) {
+                move_list = generatePawnMoves<Colors::WHITE, GT>(occupancy(m_stm, PieceTypes::PAWN), target,
+                                                             Bitboards::ZERO, Squares::NONE, move_list);
+                move_list = generateEnPassant<Colors::WHITE, false>(move_list);
+            } else {
+                move_list = generatePawnMoves<Colors::BLACK, GT>(occupancy(m_stm, PieceTypes::PAWN), target,
+                                                             Bitboards::ZERO, Squares::NONE, move_list);
+                move_list = generateEnPassant<Colors::BLACK, false>(move_list);
+            }
 
-            move_list = generatePieceMoves<PieceTypes::KNIGHT>(occupancy(m_stm, PieceTypes::KNIGHT), move_list);
-            move_list = generatePieceMoves<PieceTypes::BISHOP>(occupancy(m_stm, PieceTypes::BISHOP), move_list);
-            move_list = generatePieceMoves<PieceTypes::ROOK>(occupancy(m_stm, PieceTypes::ROOK), move_list);
-            move_list = generatePieceMoves<PieceTypes::QUEEN>(occupancy(m_stm, PieceTypes::QUEEN), move_list);
-            move_list = generatePieceMoves<PieceTypes::KING>(occupancy(m_stm, PieceTypes::KING), move_list);
+            move_list = generatePieceMoves<PieceTypes::KNIGHT>(occupancy(m_stm, PieceTypes::KNIGHT), target,
+                                                               Bitboards::ZERO, Squares::NONE, move_list);
+            move_list = generatePieceMoves<PieceTypes::BISHOP>(occupancy(m_stm, PieceTypes::BISHOP), target,
+                                                               Bitboards::ZERO, Squares::NONE, move_list);
+            move_list = generatePieceMoves<PieceTypes::ROOK>(occupancy(m_stm, PieceTypes::ROOK), target,
+                                                             Bitboards::ZERO, Squares::NONE, move_list);
+            move_list = generatePieceMoves<PieceTypes::QUEEN>(occupancy(m_stm, PieceTypes::QUEEN), target,
+                                                              Bitboards::ZERO, Squares::NONE, move_list);
+            move_list = generatePieceMoves<PieceTypes::KING>(occupancy(m_stm, PieceTypes::KING), target,
+                                                             Bitboards::ZERO, Squares::NONE, move_list);
 
             move_list = generateCastling(move_list);
-            return static_cast<size_t>(move_list - first);
-        } else if constexpr (GT == GenerationTypes::LEGAL) {
-            Move*       start = move_list;
-            Move const* end   = start + generateMoves<GenerationTypes::ALL>(move_list);
-
-            Move* out = start;
-
-            for (Move const* m = start; m < end; ++m) {
-                UndoInfo undo = makeMove(*m);
-                if (isLegal<false>()) *out++ = *m;
-                unmakeMove(*m, undo);
-            }
-
-            return static_cast<size_t>(out - start);
         } else {
-            return static_cast<size_t>(move_list - first);
+            if (m_stm == Colors::WHITE)
+                move_list = generateLegalMoves<Colors::WHITE, GT>(move_list);
+            else
+                move_list = generateLegalMoves<Colors::BLACK, GT>(move_list);
         }
+        return static_cast<size_t>(move_list - first);
+    }
+
+    [[nodiscard]] bool hasNonPawnMaterial(Color c) const {
+        return (occupancy(c) & ~occupancy(PieceTypes::PAWN) & ~occupancy(PieceTypes::KING)).any();
+    }
+
+    [[nodiscard]] bool isCapture(Move move) const {
+        return at(move.to()) != Pieces::NONE || move.flag() == MoveFlags::EN_PASSANT;
     }
 
     [[nodiscard]] Bitboard occupancy(Color c) const { return m_color[c.value()]; }
@@ -130,6 +169,8 @@ class Position {
     }
 
    private:
+    void parseFen(const std::string& fen);
+
     void setPiece(Square square, Piece p);
     void unsetPiece(Square square);
     void movePiece(Square from, Square to);
@@ -143,8 +184,19 @@ class Position {
     EnPassant m_en_passant{};
     Halfmove  m_halfmove{};
 
+    Key m_key{};
+    Key m_pawn_key{};
+    Key m_material_key{};
+
+    std::array<Score, Colors::count()> m_psqt{};
+
     template <PieceType PT>
     [[nodiscard]] constexpr Bitboard pseudoAttacks(Square square) const {
+        return pseudoAttacks<PT>(square, occupancyAll());
+    }
+
+    template <PieceType PT>
+    [[nodiscard]] static constexpr Bitboard pseudoAttacks(Square square, Bitboard occupied) {
         if constexpr (PT == PieceTypes::KNIGHT) {
             static constexpr auto table = Bitboard::pseudoAttacks(Directions::of(PieceTypes::KNIGHT));
             return table[square.value()];
@@ -152,12 +204,12 @@ class Position {
             static constexpr auto table = Bitboard::pseudoAttacks(Directions::of(PieceTypes::KING));
             return table[square.value()];
         } else if constexpr (PT == PieceTypes::BISHOP) {
-            return Magics::get().lookup<PieceTypes::BISHOP>(square, occupancyAll());
+            return Magics::get().lookup<PieceTypes::BISHOP>(square, occupied);
         } else if constexpr (PT == PieceTypes::ROOK) {
-            return Magics::get().lookup<PieceTypes::ROOK>(square, occupancyAll());
+            return Magics::get().lookup<PieceTypes::ROOK>(square, occupied);
         } else if constexpr (PT == PieceTypes::QUEEN) {
-            return Magics::get().lookup<PieceTypes::ROOK>(square, occupancyAll()) |
-                   Magics::get().lookup<PieceTypes::BISHOP>(square, occupancyAll());
+            return Magics::get().lookup<PieceTypes::ROOK>(square, occupied) |
+                   Magics::get().lookup<PieceTypes::BISHOP>(square, occupied);
         }
     }
 
@@ -172,15 +224,93 @@ class Position {
         }
     }
 
+    // own pieces standing alone between the king and an enemy slider
+    template <Color C>
+    [[nodiscard]] Bitboard pinnedPieces(Square king) const {
+        const Bitboard queens = occupancy(!C, PieceTypes::QUEEN);
+
+        Bitboard snipers =
+            (pseudoAttacks<PieceTypes::ROOK>(king, occupancy(!C)) & (occupancy(!C, PieceTypes::ROOK) | queens)) |
+            (pseudoAttacks<PieceTypes::BISHOP>(king, occupancy(!C)) & (occupancy(!C, PieceTypes::BISHOP) | queens));
+
+        Bitboard pinned = Bitboards::ZERO;
+        while (snipers.any()) {
+            const Bitboard blockers = Bitboard::between(king, poplsb(snipers)) & occupancyAll();
+            if (popcount(blockers) == 1) pinned |= blockers & occupancy(C);
+        }
+        return pinned;
+    }
+
+    // checkers and pins are computed once per node, so every emitted move is legal without making it
+    template <Color C, GenerationTypes GT>
+    Move* generateLegalMoves(Move* move_list) const {
+        const Square   king     = lsb(occupancy(C, PieceTypes::KING));
+        const Bitboard checkers = attackersTo(king, occupancyAll()) & occupancy(!C);
+
+        // pawns filter their pushes themselves, a push can still be a promotion
+        Bitboard king_target = ~occupancy(C);
+        if constexpr (GT == GenerationTypes::CAPTURES) king_target = occupancy(!C);
+        if constexpr (GT == GenerationTypes::QUIETS) king_target = ~occupancyAll();
+
+        Bitboard evasions = ~occupancy(C);
+        if (checkers.any()) {
+            if (popcount(checkers) > 1) return generateKingMoves<C>(king, king_target, move_list);
+            evasions &= Bitboard::between(king, lsb(checkers)) | checkers;
+        }
+
+        const Bitboard target = evasions & king_target;
+        const Bitboard pinned = pinnedPieces<C>(king);
+
+        move_list = generatePawnMoves<C, GT>(occupancy(C, PieceTypes::PAWN), evasions, pinned, king, move_list);
+        if constexpr (GT != GenerationTypes::QUIETS) move_list = generateEnPassant<C, true>(move_list);
+
+        // a pinned knight can never stay on the pin line
+        move_list = generatePieceMoves<PieceTypes::KNIGHT>(occupancy(C, PieceTypes::KNIGHT) & ~pinned, target,
+                                                           Bitboards::ZERO, king, move_list);
+        move_list =
+            generatePieceMoves<PieceTypes::BISHOP>(occupancy(C, PieceTypes::BISHOP), target, pinned, king, move_list);
+        move_list =
+            generatePieceMoves<PieceTypes::ROOK>(occupancy(C, PieceTypes::ROOK), target, pinned, king, move_list);
+        move_list =
+            generatePieceMoves<PieceTypes::QUEEN>(occupancy(C, PieceTypes::QUEEN), target, pinned, king, move_list);
+
+        move_list = generateKingMoves<C>(king, king_target, move_list);
+
+        if (GT != GenerationTypes::CAPTURES && checkers.empty()) move_list = generateCastling(move_list);
+
+        return move_list;
+    }
+
     template <Color C>
-    Move* generatePawnMoves(Bitboard pieces, Move* move_list) const {
+    Move* generateKingMoves(Square king, Bitboard target, Move* move_list) const {
+        // the king must not be able to hide behind itself from a slider
+        const Bitboard occupied = occupancyAll() ^ Bitboard::square(king);
+
+        Bitboard targets = pseudoAttacks<PieceTypes::KING>(king) & target;
+        while (targets.any()) {
+            const Square to = poplsb(targets);
+            if (!isAttacked(to, !C, occupied)) *move_list++ = Move(king, to);
+        }
+        return move_list;
+    }
+
+    template <Color C, GenerationTypes GT>
+    Move* generatePawnMoves(Bitboard pieces, Bitboard target, Bitboard pinned, Square king, Move* move_list) const {
+        constexpr Rank      promotion_rank = C == Colors::WHITE ? Ranks::R8 : Ranks::R1;
+        constexpr Rank      start_rank     = C == Colors::WHITE ? Ranks::R2 : Ranks::R7;
+        constexpr Direction forward        = C == Colors::WHITE ? Directions::N : Directions::S;
+
         while (pieces.any()) {
             Square from = poplsb(pieces);
 
-            Bitboard attacks = pawnAttacks<C>(from) & occupancy(!m_stm);
+            Bitboard allowed = target;
+            if (pinned.test(from)) allowed &= Bitboard::axis(king, from);
+
+            Bitboard attacks = pawnAttacks<C>(from) & occupancy(!C) & allowed;
+            if constexpr (GT == GenerationTypes::QUIETS) attacks = Bitboards::ZERO;
             while (attacks.any()) {
                 Square to = poplsb(attacks);
-                if (to.rank() == (C == Colors::WHITE ? Ranks::R8 : Ranks::R1)) {
+                if (to.rank() == promotion_rank) {
                     *move_list++ = Move(from, to, MoveFlags::PROMOTION_QUEEN);
                     *move_list++ = Move(from, to, MoveFlags::PROMOTION_ROOK);
                     *move_list++ = Move(from, to, MoveFlags::PROMOTION_BISHOP);
@@ -190,51 +320,59 @@ class Position {
                 }
             }
 
-            if (m_en_passant.hasValue()) {
-                if constexpr (C == Colors::WHITE) {
-                    if ((pawnAttacks<C>(from) & Bitboard::square(Square(m_en_passant.file(), Ranks::R6))).any())
-                        *move_list++ = Move(from, Square(m_en_passant.file(), Ranks::R6), MoveFlags::EN_PASSANT);
-                } else {
-                    if ((pawnAttacks<C>(from) & Bitboard::square(Square(m_en_passant.file(), Ranks::R3))).any()) {
-                        *move_list++ = Move(from, Square(m_en_passant.file(), Ranks::R3), MoveFlags::EN_PASSANT);
+            Square single_push = from.move(forward);
+            if ((Bitboard::square(single_push) & ~occupancyAll()).any()) {
+                if (allowed.test(single_push)) {
+                    if (single_push.rank() == promotion_rank && GT != GenerationTypes::QUIETS) {
+                        *move_list++ = Move(from, single_push, MoveFlags::PROMOTION_QUEEN);
+                        *move_list++ = Move(from, single_push, MoveFlags::PROMOTION_ROOK);
+                        *move_list++ = Move(from, single_push, MoveFlags::PROMOTION_BISHOP);
+                        *move_list++ = Move(from, single_push, MoveFlags::PROMOTION_KNIGHT);
+                    } else if (single_push.rank() != promotion_rank && GT != GenerationTypes::CAPTURES) {
+                        *move_list++ = Move(from, single_push);
                     }
                 }
-            }
 
-            Square single_push = from.move(C == Colors::WHITE ? Directions::N : Directions::S);
-            if ((Bitboard::square(single_push) & ~occupancyAll()).any()) {
-                if (single_push.rank() == (C == Colors::WHITE ? Ranks::R8 : Ranks::R1)) {
-                    *move_list++ = Move(from, single_push, MoveFlags::PROMOTION_QUEEN);
-                    *move_list++ = Move(from, single_push, MoveFlags::PROMOTION_ROOK);
-                    *move_list++ = Move(from, single_push, MoveFlags::PROMOTION_BISHOP);
-                    *move_list++ = Move(from, single_push, MoveFlags::PROMOTION_KNIGHT);
-                } else {
-                    *move_list++ = Move(from, single_push);
-
-                    if constexpr (C == Colors::WHITE) {
-                        if (from.rank() == Ranks::R2) {
-                            Square double_push = single_push.move(Directions::N);
-                            if ((Bitboard::square(double_push) & ~occupancyAll()).any())
-                                *move_list++ = Move(from, double_push, MoveFlags::PAWN_DOUBLE_PUSH);
-                        }
-                    } else {
-                        if (from.rank() == Ranks::R7) {
-                            Square double_push = single_push.move(Directions::S);
-                            if ((Bitboard::square(double_push) & ~occupancyAll()).any())
-                                *move_list++ = Move(from, double_push, MoveFlags::PAWN_DOUBLE_PUSH);
-                        }
-                    }
+                if (GT != GenerationTypes::CAPTURES && from.rank() == start_rank) {
+                    Square double_push = single_push.move(forward);
+                    if ((Bitboard::square(double_push) & ~occupancyAll() & allowed).any())
+                        *move_list++ = Move(from, double_push, MoveFlags::PAWN_DOUBLE_PUSH);
                 }
             }
         }
         return move_list;
     }
 
+    template <Color C, bool Legal>
+    Move* generateEnPassant(Move* move_list) const {
+        if (!m_en_passant.hasValue()) return move_list;
+
+        const Square to       = Square(m_en_passant.file(), C == Colors::WHITE ? Ranks::R6 : Ranks::R3);
+        const Square captured = to + (C == Colors::WHITE ? Directions::S : Directions::N);
+
+        Bitboard pawns = pawnAttacks<!C>(to) & occupancy(C, PieceTypes::PAWN);
+        while (pawns.any()) {
+            Square from = poplsb(pawns);
+
+            if constexpr (Legal) {
+                // two pawns leave the same rank at once, so pins can't be trusted here. check the resulting board
+                const Bitboard occupied =
+                    (occupancyAll() ^ Bitboard::square(from) ^ Bitboard::square(captured)) | Bitboard::square(to);
+                const Square king = lsb(occupancy(C, PieceTypes::KING));
+                if ((attackersTo(king, occupied) & occupancy(!C) & ~Bitboard::square(captured)).any()) continue;
+            }
+
+            *move_list++ = Move(from, to, MoveFlags::EN_PASSANT);
+        }
+        return move_list;
+    }
+
     template <PieceType PT>
-    Move* generatePieceMoves(Bitboard pieces, Move* move_list) const {
+    Move* generatePieceMoves(Bitboard pieces, Bitboard target, Bitboard pinned, Square king, Move* move_list) const {
         while (pieces.any()) {
             Square   from    = poplsb(pieces);
-            Bitboard targets = pseudoAttacks<PT>(from) & ~occupancy(m_stm);
+            Bitboard targets = pseudoAttacks<PT>(from) & target;
+            if (pinned.test(from)) targets &= Bitboard::axis(king, from);
             while (targets.any()) {
                 *move_list++ = Move(from, poplsb(targets));
             }
@@ -246,23 +384,27 @@ class Position {
         if (m_stm == Colors::WHITE) {
             if (m_castling.has(Castlings::W_KING_SIDE) &&
                 !(Bitboard::between(Squares::E1, Squares::H1) & occupancyAll()).any()) {
-                if (!isAttacked(Squares::E1, Colors::BLACK) && !isAttacked(Squares::F1, Colors::BLACK))
+                if (!isAttacked(Squares::E1, Colors::BLACK) && !isAttacked(Squares::F1, Colors::BLACK) &&
+                    !isAttacked(Squares::G1, Colors::BLACK))
                     *move_list++ = Move(Squares::E1, Squares::G1, MoveFlags::CASTLING_KING);
             }
             if (m_castling.has(Castlings::W_QUEEN_SIDE) &&
                 !(Bitboard::between(Squares::E1, Squares::A1) & occupancyAll()).any()) {
-                if (!isAttacked(Squares::E1, Colors::BLACK) && !isAttacked(Squares::D1, Colors::BLACK))
+                if (!isAttacked(Squares::E1, Colors::BLACK) && !isAttacked(Squares::D1, Colors::BLACK) &&
+                    !isAttacked(Squares::C1, Colors::BLACK))
                     *move_list++ = Move(Squares::E1, Squares::C1, MoveFlags::CASTLING_QUEEN);
             }
         } else {
             if (m_castling.has(Castlings::B_KING_SIDE) &&
                 !(Bitboard::between(Squares::E8, Squares::H8) & occupancyAll()).any()) {
-                if (!isAttacked(Squares::E8, Colors::WHITE) && !isAttacked(Squares::F8, Colors::WHITE))
+                if (!isAttacked(Squares::E8, Colors::WHITE) && !isAttacked(Squares::F8, Colors::WHITE) &&
+                    !isAttacked(Squares::G8, Colors::WHITE))
                     *move_list++ = Move(Squares::E8, Squares::G8, MoveFlags::CASTLING_KING);
             }
             if (m_castling.has(Castlings::B_QUEEN_SIDE) &&
                 !(Bitboard::between(Squares::E8, Squares::A8) & occupancyAll()).any()) {
-                if (!isAttacked(Squares::E8, Colors::WHITE) && !isAttacked(Squares::D8, Colors::WHITE))
+                if (!isAttacked(Squares::E8, Colors::WHITE) && !isAttacked(Squares::D8, Colors::WHITE) &&
+                    !isAttacked(Squares::C8, Colors::WHITE))
                     *move_list++ = Move(Squares::E8, Squares::C8, MoveFlags::CASTLING_QUEEN);
             }
         }
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "color.hpp"
+#include "piece.hpp"
+#include "piece_type.hpp"
+#include "score.hpp"
+#include "square.hpp"
+
+// PeSTO's material and piece-square values. the position keeps their sums per color up to date as pieces come and
+// go, so the evaluation only blends the two phases instead of scanning the board
+namespace Psqt {
+inline constexpr int MAX_PHASE = 24;
+
+// clang-format off
+inline constexpr std::array<Score, PieceTypes::count()> PIECE_VALUE = {
+    Score(82, 94), Score(337, 281), Score(365, 297), Score(477, 512), Score(1025, 936), Score(0, 0)
+};
+
+inline constexpr std::array<int, PieceTypes::count()> PHASE_WEIGHT = { 0, 1, 1, 2, 4, 0 };
+
+inline constexpr std::array<int, Squares::count()> PAWN_PST = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+     98, 134,  61,  95,  68, 126,  34, -11,
+     -6,   7,  26,  31,  65,  56,  25, -20,
+    -14,  13,   6,  21,  23,  12,  17, -23,
+    -27,  -2,  -5,  12,  17,   6,  10, -25,
+    -26,  -4,  -4, -10,   3,   3,  33, -12,
+    -35,  -1, -20, -23, -15,  24,  38, -22,
+      0,   0,   0,   0,   0,   0,   0,   0
+};
+
+inline constexpr std::array<int, Squares::count()> KNIGHT_PST = {
+    -167, -89, -34, -49,  61, -97, -15, -107,
+     -73, -41,  72,  36,  23,  62,   7,  -17,
+     -47,  60,  37,  65,  84, 129,  73,   44,
+      -9,  17,  19,  53,  37,  69,  18,   22,
+     -13,   4,  16,  13,  28,  19,  21,   -8,
+     -23,  -9,  12,  10,  19,  17,  25,  -16,
+     -29, -53, -12,  -3,  -1,  18, -14,  -19,
+    -105, -21, -58, -33, -17, -28, -19,  -23
+};
+
+inline constexpr std::array<int, Squares::count()> BISHOP_PST = {
+    -29,   4, -82, -37, -25, -42,   7,  -8,
+    -26,  16, -18, -13,  30,  59,  18, -47,
+    -16,  37,  43,  40,  35,  50,  37,  -2,
+     -4,   5,  19,  50,  37,  37,   7,  -2,
+     -6,  13,  13,  26,  34,  12,  10,   4,
+      0,  15,  15,  15,  14,  27,  18,  10,
+      4,  15,  16,   0,   7,  21,  33,   1,
+    -33,  -3, -14, -21, -13, -12, -39, -21
+};
+
+inline constexpr std::array<int, Squares::count()> ROOK_PST = {
+     32,  42,  32,  51, 63,  9,  31,  43,
+     27,  32,  58,  62, 80, 67,  26,  44,
+     -5,  19,  26,  36, 17, 45,  61,  16,
+    -24, -11,   7,  26, 24, 35,  -8, -20,
+    -36, -26, -12,  -1,  9, -7,   6, -23,
+    -45, -25, -16, -17,  3,  0,  -5, -33,
+    -44, -16, -20,  -9, -1, 11,  -6, -71,
+    -19, -13,   1,  17, 16,  7, -37, -26
+};
+
+inline constexpr std::array<int, Squares::count()> QUEEN_PST = {
+    -28,   0,  29,  12,  59,  44,  43,  45,
+    -24, -39,  -5,   1, -16,  57,  28,  54,
+    -13, -17,   7,   8,  29,  56,  47,  57,
+    -27, -27, -16, -16,  -1,  17,  -2,   1,
+     -9, -26,  -9, -10,  -2,  -4,   3,  -3,
+    -14,   2, -11,  -2,  -5,   2,  14,   5,
+    -35,  -8,  11,   2,   8,  15,  -3,   1,
+     -1, -18,  -9,  -19, -30, -15, -60, -54
+};
+
+inline constexpr std::array<int, Squares::count()> KING_MG_PST = {
+    -65,  23,  16, -15, -56, -34,   2,  13,
+     29,  -1, -20,  -7,  -8,  -4, -38, -29,
+     -9,  24,   2, -16, -20,   6,  22, -22,
+    -17, -20, -12, -27, -30, -25, -14, -36,
+    -49,  -1, -27, -39, -46, -44, -33, -51,
+    -14, -14, -22, -46, -44, -30, -15, -27,
+      1,   7,  -8, -64, -43, -16,   9,   8,
+    -15,  36,  12, -54,   8, -28,  24,  14
+};
+
+inline constexpr std::array<int, Squares::count()> KING_EG_PST = {
+    -74, -35, -18, -18, -11,  15,   4, -17,
+    -12,  17,  14,  17,  17,  38,  23,  11,
+     10,  17,  23,  15,  20,  45,  44,  13,
+     -8,  22,  24,  27,  26,  33,  26,   3,
+    -18,  -4,  21,  24,  21,  23,  12, -11,
+    -19,  -3,  11,  21,  23,  16,   7,  -9,
+    -27, -11,   4,  13,  14,   4,  -5, -17,
+    -53, -34, -21, -11, -28, -14, -24, -43
+};
+// clang-format on
+
+struct Tables {
+    // material and square together, indexed by the raw piece value like the zobrist keys
+    std::array<std::array<Score, Squares::count()>, 1 << (Color::width() + PieceType::width())> scores{};
+    std::array<int, 1 << (Color::width() + PieceType::width())>                                 phase{};
+};
+
+inline constexpr Tables TABLES = []() constexpr {
+    Tables tables{};
+
+    for (const Piece piece : Pieces::all()) {
+        const size_t type = piece.type().value();
+
+        // the king has a table per phase, the other pieces share one
+        std::array<int, Squares::count()> midgame = KING_MG_PST;
+        std::array<int, Squares::count()> endgame = KING_EG_PST;
+        if (piece.type() == PieceTypes::PAWN) midgame = endgame = PAWN_PST;
+        if (piece.type() == PieceTypes::KNIGHT) midgame = endgame = KNIGHT_PST;
+        if (piece.type() == PieceTypes::BISHOP) midgame = endgame = BISHOP_PST;
+        if (piece.type() == PieceTypes::ROOK) midgame = endgame = ROOK_PST;
+        if (piece.type() == PieceTypes::QUEEN) midgame = endgame = QUEEN_PST;
+
+        for (const Square square : Squares::all()) {
+            // the tables are written from white's side, black reads them mirrored
+            const size_t index = piece.color() == Colors::WHITE ? square.value() : square.value() ^ 56;
+
+            tables.scores[piece.value()][square.value()] = PIECE_VALUE[type] + Score(midgame[index], endgame[index]);
+        }
+        tables.phase[piece.value()] = PHASE_WEIGHT[type];
+    }
+    return tables;
+}();
+
+[[nodiscard]] constexpr Score score(Piece piece, Square square) { return TABLES.scores[piece.value()][square.value()]; }
+[[nodiscard]] constexpr int phase(Piece piece) { return TABLES.phase[piece.value()]; }
+};  // namespace Psqt
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "castling.hpp"
+#include "color.hpp"
+#include "en_passant.hpp"
+#include "file.hpp"
+#include "piece.hpp"
+#include "piece_type.hpp"
+#include "prng.hpp"
+#include "square.hpp"
+
+using Key = uint64_t;
+
+namespace Zobrist {
+struct Keys {
+    // indexed by the raw piece value to skip the color/type split, the unused slots stay zero
+    std::array<std::array<Key, Squares::count()>, 1 << (Color::width() + PieceType::width())> pieces{};
+    std::array<Key, 1 << Castling::width()>                                                   castling{};
+    std::array<Key, Files::count()>                                                           en_passant{};
+    Key                                                                                       side{};
+};
+
+// generated at compile time, so the keys are identical between builds and runs
+inline constexpr Keys KEYS = []() constexpr {
+    Keys keys{};
+    Prng rng(1070372);
+
+    for (const Piece piece : Pieces::all()) {
+        for (auto& key : keys.pieces[piece.value()]) key = rng.rand<Key>();
+    }
+    for (size_t i = 1; i < keys.castling.size(); ++i) keys.castling[i] = rng.rand<Key>();
+    for (auto& key : keys.en_passant) key = rng.rand<Key>();
+    keys.side = rng.rand<Key>();
+
+    return keys;
+}();
+
+[[nodiscard]] constexpr Key piece(Piece piece, Square square) { return KEYS.pieces[piece.value()][square.value()]; }
+[[nodiscard]] constexpr Key castling(Castling castling) { return KEYS.castling[castling.value()]; }
+[[nodiscard]] constexpr Key enPassant(EnPassant en_passant) {
+    return en_passant.hasValue() ? KEYS.en_passant[en_passant.file().value()] : 0;
+}
+[[nodiscard]] constexpr Key side() { return KEYS.side; }
+};  // namespace Zobrist
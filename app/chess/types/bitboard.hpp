@@ -253,6 +253,15 @@ struct Bitboard : public StrongValue<Bitboard, uint64_t> {
         }();
         return table[from.value()][to.value()];
     }
+
+    // whole rank, file or diagonal passing through both squares, empty if they are not aligned
+    static constexpr Bitboard axis(Square from, Square to) {
+        if (from.rank() == to.rank()) return Bitboard::rank(from.rank());
+        if (from.file() == to.file()) return Bitboard::file(from.file());
+        if (from.diag() == to.diag()) return Bitboard::diag(from);
+        if (from.antiDiag() == to.antiDiag()) return Bitboard::antiDiag(from);
+        return Bitboard(0);
+    }
 };
 
 namespace Bitboards {
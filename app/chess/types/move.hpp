@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cassert>
+
 #include "move.hpp"
 #include "move_flag.hpp"
+#include "piece_type.hpp"
 #include "square.hpp"
 #include "strong_value.hpp"
 
@@ -18,6 +21,20 @@ struct Move : public StrongValue<Move, uint16_t> {
 
     [[nodiscard]] constexpr MoveFlag flag() const { return MoveFlag((m_value >> MOVEFLAG_SHIFT) & MoveFlag::mask()); }
 
+    [[nodiscard]] constexpr bool isPromotion() const {
+        return flag().value() >= MoveFlags::PROMOTION_QUEEN.value() &&
+               flag().value() <= MoveFlags::PROMOTION_KNIGHT.value();
+    }
+
+    // only meaningful when isPromotion() holds
+    [[nodiscard]] constexpr PieceType promotionType() const {
+        assert(isPromotion());
+        if (flag() == MoveFlags::PROMOTION_QUEEN) return PieceTypes::QUEEN;
+        if (flag() == MoveFlags::PROMOTION_ROOK) return PieceTypes::ROOK;
+        if (flag() == MoveFlags::PROMOTION_BISHOP) return PieceTypes::BISHOP;
+        return PieceTypes::KNIGHT;
+    }
+
     static constexpr Move fromString(const std::string& str) {
         MoveFlag promotion = MoveFlags::USUAL;
         if (str.size() == 5) {
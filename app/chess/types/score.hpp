@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include "strong_value.hpp"
+
+// a midgame and an endgame value in one integer, the endgame in the upper half, so one add updates both. a negative
+// midgame borrows one from the endgame half, reading the endgame rounds that borrow back in
+struct Score : public StrongValue<Score, int32_t> {
+    using StrongValue::StrongValue;
+
+    constexpr Score(int midgame, int endgame) noexcept
+        : StrongValue(static_cast<int32_t>((static_cast<uint32_t>(endgame) << 16) + static_cast<uint32_t>(midgame))) {}
+
+    [[nodiscard]] constexpr int midgame() const noexcept {
+        return static_cast<int16_t>(static_cast<uint16_t>(static_cast<uint32_t>(m_value)));
+    }
+    [[nodiscard]] constexpr int endgame() const noexcept {
+        return static_cast<int16_t>(static_cast<uint16_t>((static_cast<uint32_t>(m_value) + 0x8000) >> 16));
+    }
+
+    // wrapping unsigned arithmetic, the halves are whole again once extracted
+    constexpr Score& operator+=(Score other) noexcept {
+        m_value = static_cast<int32_t>(static_cast<uint32_t>(m_value) + static_cast<uint32_t>(other.m_value));
+        return *this;
+    }
+    constexpr Score& operator-=(Score other) noexcept {
+        m_value = static_cast<int32_t>(static_cast<uint32_t>(m_value) - static_cast<uint32_t>(other.m_value));
+        return *this;
+    }
+
+    friend constexpr Score operator+(Score lhs, Score rhs) noexcept { return lhs += rhs; }
+    friend constexpr Score operator-(Score lhs, Score rhs) noexcept { return lhs -= rhs; }
+    friend constexpr Score operator-(Score score) noexcept { return Score() - score; }
+    friend constexpr Score operator*(Score score, int factor) noexcept {
+        return Score(static_cast<int32_t>(static_cast<uint32_t>(score.m_value) * static_cast<uint32_t>(factor)));
+    }
+};
+
+static_assert(Score(-3, 5).midgame() == -3 && Score(-3, 5).endgame() == 5, "Halves must survive the borrow");
+static_assert((Score(10, -20) - Score(30, 40) * 2).endgame() == -100, "Arithmetic must work on both halves");
@@ -39,11 +39,21 @@ class Uci {
         if (cmd == "uci") {
             std::cout << "id name " << AppInfo::NAME << " " << AppInfo::VERSION << std::endl;
             std::cout << "id author " << AppInfo::AUTHOR << std::endl;
+            std::cout << "option name Hash type spin default " << TranspositionTable::DEFAULT_SIZE_MB << " min 1 max "
+                      << TranspositionTable::MAX_SIZE_MB << std::endl;
+            std::cout << "option name Threads type spin default 1 min 1 max " << Engine::MAX_THREADS << std::endl;
+            std::cout << "option name Move Overhead type spin default " << TimeManager::DEFAULT_MOVE_OVERHEAD_MS
+                      << " min 0 max " << TimeManager::MAX_MOVE_OVERHEAD_MS << std::endl;
+            std::cout << "option name MultiPV type spin default 1 min 1 max " << Engine::MAX_MULTI_PV << std::endl;
+            std::cout << "option name QSearchChecks type check default false" << std::endl;
             std::cout << "uciok" << std::endl;
         } else if (cmd == "isready") {
             std::cout << "readyok" << std::endl;
+        } else if (cmd == "setoption") {
+            setOption(tokens);
         } else if (cmd == "ucinewgame") {
             m_engine.newGame();
+            m_engine.clearHash();
         } else if (cmd == "position") {
             setPosition(tokens);
         } else if (cmd == "go") {
@@ -59,11 +69,49 @@ class Uci {
         }
     }
 
+    void setOption(std::deque<std::string>& tokens) {
+        if (tokens.empty() || tokens.front() != "name") return;
+        tokens.pop_front();
+
+        std::string name;
+        while (!tokens.empty() && tokens.front() != "value") {
+            name += (name.empty() ? "" : " ") + tokens.front();
+            tokens.pop_front();
+        }
+
+        std::string value;
+        if (!tokens.empty()) {
+            tokens.pop_front();
+            while (!tokens.empty()) {
+                value += (value.empty() ? "" : " ") + tokens.front();
+                tokens.pop_front();
+            }
+        }
+
+        try {
+            if (name == "Hash") {
+                m_engine.setHashSize(static_cast<size_t>(std::stoul(value)));
+            } else if (name == "Threads") {
+                m_engine.setThreads(static_cast<size_t>(std::stoul(value)));
+            } else if (name == "Move Overhead") {
+                m_engine.setMoveOverhead(std::stoi(value));
+            } else if (name == "MultiPV") {
+                m_engine.setMultiPV(static_cast<size_t>(std::stoul(value)));
+            } else if (name == "QSearchChecks") {
+                m_engine.setQSearchChecks(value == "true");
+            } else {
+                std::cout << "No such option: " << name << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error parsing option value: " << value << std::endl;
+        }
+    }
+
     void setPosition(std::deque<std::string>& tokens) {
         if (tokens.empty()) return;
 
         if (tokens.front() == "startpos") {
-            m_engine.newGame();
+            m_engine.startPosition();
             tokens.pop_front();
         } else if (tokens.front() == "fen") {
             tokens.pop_front();
@@ -85,25 +133,15 @@ class Uci {
     }
 
     void go(std::deque<std::string>& tokens) {
-        if (tokens.empty()) m_engine.go(SearchParameters{});
+        if (tokens.empty()) {
+            m_engine.go(SearchParameters{});
+            return;
+        }
 
         if (tokens.front() == "perft") {
             tokens.pop_front();
-            int depth = 1;
-            if (!tokens.empty()) {
-                try {
-                    depth = std::stoi(tokens.front());
-                    tokens.pop_front();
-                } catch (const std::exception& e) {
-                    std::cerr << "Error: " << e.what() << std::endl;
-                    return;
-                }
-            }
-
-            auto nodes = m_engine.perft(depth);
-
-            std::cout << std::endl;
-            std::cout << "Nodes searched: " << nodes << std::endl;
+            perft(tokens);
+            return;
         }
 
         SearchParameters params;
@@ -119,6 +157,15 @@ class Uci {
                 } else if (token == "btime" && !tokens.empty()) {
                     params.btime_ms = std::stoi(tokens.front());
                     tokens.pop_front();
+                } else if (token == "winc" && !tokens.empty()) {
+                    params.winc_ms = std::stoi(tokens.front());
+                    tokens.pop_front();
+                } else if (token == "binc" && !tokens.empty()) {
+                    params.binc_ms = std::stoi(tokens.front());
+                    tokens.pop_front();
+                } else if (token == "movestogo" && !tokens.empty()) {
+                    params.movestogo = std::stoi(tokens.front());
+                    tokens.pop_front();
                 } else if (token == "movetime" && !tokens.empty()) {
                     params.max_time_ms = std::stoi(tokens.front());
                     tokens.pop_front();
@@ -136,6 +183,40 @@ class Uci {
         m_engine.go(params);
     }
 
+    // go perft <depth> [hash <mb>] [threads <n>]
+    void perft(std::deque<std::string>& tokens) {
+        int    depth   = 1;
+        size_t hash_mb = 0;
+        size_t threads = 1;
+
+        try {
+            if (!tokens.empty()) {
+                depth = std::stoi(tokens.front());
+                tokens.pop_front();
+            }
+            while (!tokens.empty()) {
+                std::string token = tokens.front();
+                tokens.pop_front();
+
+                if (token == "hash" && !tokens.empty()) {
+                    hash_mb = static_cast<size_t>(std::stoul(tokens.front()));
+                    tokens.pop_front();
+                } else if (token == "threads" && !tokens.empty()) {
+                    threads = static_cast<size_t>(std::stoul(tokens.front()));
+                    tokens.pop_front();
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return;
+        }
+
+        auto nodes = m_engine.perft(depth, hash_mb, threads);
+
+        std::cout << std::endl;
+        std::cout << "Nodes searched: " << nodes << std::endl;
+    }
+
     void stop() { m_engine.stop(); }
 
     bool m_shouldQuit{false};
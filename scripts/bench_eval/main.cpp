@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "evaluation.hpp"
+#include "material_table.hpp"
+#include "pawn_table.hpp"
+#include "position.hpp"
+#include "psqt.hpp"
+#include "score.hpp"
+
+// the cost of one leaf evaluation: the sums the position keeps against the board scan the evaluation used to do.
+// usage: bench_eval [depth] [rounds]
+
+namespace {
+const std::array<std::string, 4> FENS = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+};
+
+// every square looked at, the piece and the tables read for each occupied one. the pawn and material terms are the
+// same
+int scanEvaluate(const Position& position, PawnTable& pawn_table, MaterialTable& material_table) {
+    const MaterialEntry& material = material_table.probe(position);
+    if (material.evaluator != nullptr) return material.evaluator(position, material.strong);
+
+    Score score{};
+    int   phase = 0;
+
+    for (const Square square : Squares::all()) {
+        const Piece piece = position.at(square);
+        if (piece == Pieces::NONE) continue;
+
+        score += piece.color() == Colors::WHITE ? Psqt::score(piece, square) : -Psqt::score(piece, square);
+        phase += Psqt::phase(piece);
+    }
+
+    PawnEntry& pawns = pawn_table.probe(position);
+    score += pawns.score + PawnTable::shelter(position, Colors::WHITE, pawns) -
+             PawnTable::shelter(position, Colors::BLACK, pawns) + material.imbalance;
+
+    const int scale    = material.scale[(score.endgame() > 0 ? Colors::WHITE : Colors::BLACK).value()];
+    const int endgame  = score.endgame() * scale / MaterialEntry::SCALE_NORMAL;
+    const int mg_phase = std::min(phase, Psqt::MAX_PHASE);
+    const int eg_phase = Psqt::MAX_PHASE - mg_phase;
+    const int white    = (score.midgame() * mg_phase + endgame * eg_phase) / Psqt::MAX_PHASE;
+    return position.us() == Colors::WHITE ? white : -white;
+}
+
+// the leaves of a small tree, so the positions look like the ones a search evaluates
+void collect(Position& position, int depth, std::vector<Position>& leaves) {
+    if (depth == 0) {
+        leaves.push_back(position);
+        return;
+    }
+
+    std::array<Move, 256> moves{};
+    const size_t          size = position.generateMoves<GenerationTypes::LEGAL>(moves.data());
+    for (size_t i = 0; i < size; ++i) {
+        const UndoInfo undo = position.makeMove(moves[i]);
+        collect(position, depth - 1, leaves);
+        position.unmakeMove(moves[i], undo);
+    }
+}
+
+template <typename Evaluate>
+double nanosecondsPerCall(const std::vector<Position>& leaves, int rounds, Evaluate evaluate, int64_t& sum) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const Position& position : leaves) sum += evaluate(position);
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(leaves.size()) * rounds);
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int depth  = argc > 1 ? std::stoi(argv[1]) : 3;
+    const int rounds = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    std::vector<Position> leaves;
+    for (const std::string& fen : FENS) {
+        Position position(fen);
+        collect(position, depth, leaves);
+    }
+
+    // a table each, so neither finds entries the other one filled
+    PawnTable     scan_pawns;
+    PawnTable     pawns;
+    MaterialTable scan_material;
+    MaterialTable material;
+
+    auto scan_evaluate = [&](const Position& position) {
+        return scanEvaluate(position, scan_pawns, scan_material);
+    };
+    auto evaluate = [&](const Position& position) { return Evaluation::evaluate(position, pawns, material); };
+
+    // both have to agree on every leaf, the sums are only worth it if they are exact
+    for (const Position& position : leaves) {
+        if (evaluate(position) != scan_evaluate(position)) {
+            std::cerr << "mismatch in " << position.toFen() << '\n';
+            return 1;
+        }
+    }
+
+    int64_t      scan_sum        = 0;
+    int64_t      incremental_sum = 0;
+    const double scan            = nanosecondsPerCall(leaves, rounds, scan_evaluate, scan_sum);
+    const double incremental     = nanosecondsPerCall(leaves, rounds, evaluate, incremental_sum);
+
+    std::cout << leaves.size() << " leaves, " << rounds << " rounds\n";
+    std::cout << "board scan:  " << scan << " ns per evaluation\n";
+    std::cout << "incremental: " << incremental << " ns per evaluation\n";
+    std::cout << "speedup:     " << scan / incremental << "x\n";
+    std::cout << "pawn hits:   " << (pawns.probes() == 0 ? 0 : pawns.hits() * 100 / pawns.probes()) << "%\n";
+    return scan_sum == incremental_sum ? 0 : 1;
+}
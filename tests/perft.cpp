@@ -11,6 +11,30 @@ TEST(Perft, PerftMicroset) {
     EXPECT_EQ(engine.perft(3), 8902);
 }
 
+TEST(Perft, PerftHashed) {
+    Engine engine;
+
+    engine.fromFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    EXPECT_EQ(engine.perft(5, 16), 4865609);
+
+    engine.fromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    EXPECT_EQ(engine.perft(4, 16), 4085603);
+
+    engine.fromFen("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+    EXPECT_EQ(engine.perft(6, 16), 11030083);
+}
+
+TEST(Perft, PerftThreaded) {
+    Engine engine;
+
+    engine.fromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    EXPECT_EQ(engine.perft(4, 0, 4), 4085603);
+    EXPECT_EQ(engine.perft(4, 16, 4), 4085603);
+
+    engine.fromFen("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
+    EXPECT_EQ(engine.perft(4, 0, 3), 2103487);
+}
+
 TEST(Perft, PerftMidset) {
     Engine engine;
 
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "engine.hpp"
+
+namespace {
+std::atomic<size_t> allocations{0};
+}
+
+// kept out of line, once inlined the compiler pairs malloc with delete and warns about a mismatch
+[[gnu::noinline]] void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+    throw std::bad_alloc();
+}
+[[gnu::noinline]] void operator delete(void* pointer) noexcept { std::free(pointer); }
+[[gnu::noinline]] void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+TEST(Search, NoAllocationsDuringSearch) {
+    const Position position("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+    // a throwaway search gets whatever is process wide out of the way, the stream buffers among it
+    Engine warmup;
+    warmup.search(position, SearchParameters{.max_depth = 3});
+
+    // the engine owns its tables and frames from construction on, the search itself must not touch the heap
+    Engine       engine;
+    const size_t before = allocations.load();
+    engine.search(position, SearchParameters{.max_depth = 6});
+    EXPECT_EQ(allocations.load() - before, 0);
+}
+
+TEST(Search, SearchesTwiceOnOneEngine) {
+    // mate in one, the second search must not start out stopped by the end of the first
+    const Position position("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+
+    Engine engine;
+    for (int i = 0; i < 2; ++i) {
+        engine.search(position, SearchParameters{.max_depth = 4});
+        EXPECT_EQ(engine.getCurrentBestMove().toString(), "a1a8");
+        EXPECT_EQ(engine.getCurrentEval(), Evaluation::MATE_SCORE - 1);
+    }
+}
+
+TEST(Search, FiftyMoveRuleIsADraw) {
+    // a queen up, but the next reversible move reaches the hundredth halfmove
+    const Position position("8/8/8/4k3/8/8/3QK3/8 w - - 99 80");
+
+    Engine engine;
+    engine.search(position, SearchParameters{.max_depth = 4});
+    EXPECT_EQ(engine.getCurrentEval(), 0);
+}
+
+TEST(Search, MateOnTheHundredthHalfmoveIsAMate) {
+    // the mating move is also the hundredth reversible halfmove, the mate comes first
+    const Position position("7k/8/6K1/8/8/8/8/R7 w - - 99 80");
+
+    Engine engine;
+    engine.search(position, SearchParameters{.max_depth = 4});
+    EXPECT_EQ(engine.getCurrentEval(), Evaluation::MATE_SCORE - 1);
+}
+
+TEST(Search, RepetitionIsADraw) {
+    // a queen and a rook down, but Qe8+ Kh7 Qh5+ Kg8 checks forever and the line comes back to itself
+    const Position position("6k1/6p1/3K1p2/8/8/8/4Q3/qr6 w - - 0 1");
+
+    Engine engine;
+    engine.search(position, SearchParameters{.max_depth = 8});
+    EXPECT_EQ(engine.getCurrentBestMove().toString(), "e2e8");
+    EXPECT_EQ(engine.getCurrentEval(), 0);
+}
+
+TEST(Search, InsufficientMaterialIsADraw) {
+    // a knight up, but a lone knight can never mate
+    const Position position("8/8/4k3/8/8/3NK3/8/8 w - - 0 1");
+
+    Engine engine;
+    engine.search(position, SearchParameters{.max_depth = 4});
+    EXPECT_EQ(engine.getCurrentEval(), 0);
+}
+
+TEST(Search, SameColoredBishopsAreADraw) {
+    // two bishops outweigh a rook, but both on light squares they can never mate
+    const Position position("8/8/4k3/8/8/3BKB2/8/8 w - - 0 1");
+
+    Engine engine;
+    engine.search(position, SearchParameters{.max_depth = 4});
+    EXPECT_EQ(engine.getCurrentEval(), 0);
+}
+
+TEST(Search, MatingMaterialIsAKnownWin) {
+    // the bare king endgames that are won score above anything the general evaluation returns
+    for (const char* fen : {"8/8/4k3/8/8/4K3/8/R7 w - - 0 1", "8/8/4k3/8/8/3NKB2/8/8 w - - 0 1",
+                            "8/8/4k3/8/8/2B1KB2/8/8 w - - 0 1"}) {
+        Engine engine;
+        engine.search(Position(fen), SearchParameters{.max_depth = 4});
+        EXPECT_GE(engine.getCurrentEval(), Endgames::KNOWN_WIN) << fen;
+    }
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "position.hpp"
+#include "psqt.hpp"
+
+namespace {
+constexpr int value(PieceType type) { return Psqt::PIECE_VALUE[type.value()].midgame(); }
+
+constexpr int PAWN   = value(PieceTypes::PAWN);
+constexpr int KNIGHT = value(PieceTypes::KNIGHT);
+constexpr int BISHOP = value(PieceTypes::BISHOP);
+constexpr int ROOK   = value(PieceTypes::ROOK);
+constexpr int QUEEN  = value(PieceTypes::QUEEN);
+
+// the exchange is worth exactly the expected value, so it passes that threshold and fails the next one
+void expectSee(const std::string& fen, const std::string& move, int expected) {
+    const Position position(fen);
+    const Move     parsed = Move::fromString(move);
+
+    EXPECT_TRUE(position.see(parsed, expected)) << fen << ' ' << move;
+    EXPECT_FALSE(position.see(parsed, expected + 1)) << fen << ' ' << move;
+}
+}  // namespace
+
+TEST(See, UndefendedCapture) {
+    expectSee("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", PAWN);
+    expectSee("4k3/8/8/8/8/8/3p4/4K3 w - - 0 1", "e1d2", PAWN);
+}
+
+TEST(See, DefendedCapture) {
+    expectSee("4k3/8/2p5/3p4/8/8/8/3QK3 w - - 0 1", "d1d5", PAWN - QUEEN);
+    expectSee("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", PAWN - KNIGHT);
+    expectSee("4r1k1/5pp1/nbp4p/1p2p2q/1P2P1b1/1BP2N1P/1B2QPPK/3R4 b - - 0 1", "g4f3", KNIGHT - BISHOP);
+}
+
+TEST(See, XRayAttackers) {
+    // the second rook only joins once the first has taken
+    expectSee("4k3/4r3/8/4p3/8/8/4R3/4R1K1 w - - 0 1", "e2e5", PAWN);
+    expectSee("4k3/4r3/8/4p3/8/8/8/4R1K1 w - - 0 1", "e1e5", PAWN - ROOK);
+
+    // a queen behind a bishop backs it up on the diagonal, on either side
+    expectSee("4k3/8/8/5b2/4p3/3B4/2Q5/4K3 w - - 0 1", "d3e4", PAWN);
+    expectSee("4k3/8/6q1/5b2/4p3/3B4/2Q5/4K3 w - - 0 1", "d3e4", PAWN - BISHOP);
+}
+
+TEST(See, QuietMoves) {
+    expectSee("4k3/8/3p4/8/4N3/8/8/4K3 w - - 0 1", "e4c5", -KNIGHT);
+    expectSee("4k3/8/3p4/8/4N3/8/8/4K3 w - - 0 1", "e4f6", 0);
+}
+
+TEST(See, SpecialMovesAreEven) {
+    expectSee("4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8q", 0);
+}